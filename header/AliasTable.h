@@ -0,0 +1,32 @@
+#ifndef __AliasTable_h__
+#define __AliasTable_h__
+
+#include <vector>
+
+/*
+* @brief Walker/Vose alias table of households (by PUMS SERIALNO) of one household
+*        type, size and income. Built by IPU from final household weights.
+*/
+struct AliasTable
+{
+	std::vector<double> prob;
+	std::vector<int> alias;
+	std::vector<double> hhIdx;
+
+	/*
+	* @brief Draws a household in O(1)
+	* @param randomP Uniform random number in [0, 1)
+	* @return SERIALNO of drawn household
+	*/
+	double draw(double randomP) const
+	{
+		double x = randomP*prob.size();
+		size_t k = (size_t)x;
+		if(k >= prob.size())
+			k = prob.size()-1;
+
+		return (x-k < prob[k]) ? hhIdx[k] : hhIdx[alias[k]];
+	}
+};
+
+#endif //__AliasTable_h__
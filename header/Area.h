@@ -13,12 +13,15 @@
 
 #include "PersonPums.h"
 #include "HouseholdPums.h"
+#include "AliasTable.h"
+#include "Counter.h"
 
 class County;
 //class Parameters;
 class CardioCounter;
 class ViolenceCounter;
 class CardioModel;
+class Random;
 
 template <class GenericParams>
 class IPUWrapper;
@@ -32,6 +35,9 @@ public:
 	typedef std::multimap<int, std::multimap<std::string, Columns>> ACSEstimates;
 	typedef std::pair<double, double> PairDD;
 	typedef std::map<std::string, std::map<double,std::vector<PairDD>>> ProbMap;
+	typedef std::map<std::string, AliasTable> AliasMap;
+	typedef std::vector<double> HouseholdList;
+	typedef std::map<std::string, std::vector<std::pair<double, int>>> ReplicationMap;
 	
 	typedef std::map<int,std::map<std::string, PairDD>> RiskFacMap;
 	typedef std::map<std::string, PairDD> PairMap;
@@ -58,16 +64,34 @@ public:
 	std::multimap<int, County> getPumaCountyMap() const;
 	int getCountyNum(std::string) const;
 
+	void createIPU();
+
 	template <class T>
 	void createAgents(T *);
+	template <class T>
+	void createAgents(T *, unsigned int);
 	
 protected:
 	
 	template <class T>
-	void drawHouseholds(IPUWrapper<GenericParams> *, T *);
+	void drawHouseholds(IPUWrapper<GenericParams> *, T *, unsigned int);
+
+	void drawHouseholdTypes(IPUWrapper<GenericParams> *, int, int, unsigned int, 
+		Counter<GenericParams> *, std::vector<HouseholdList> *, int *);
+	int countHousehold(int, const HouseholdPums<GenericParams> *, Counter<GenericParams> *) const;
+
+	template <class T>
+	void replicateHouseholds(IPUWrapper<GenericParams> *, T *);
+
+	template <class T>
+	void addDrawnHouseholds(IPUWrapper<GenericParams> *, const std::vector<HouseholdList> &, T *);
+
+	void repairFit(IPUWrapper<GenericParams> *, std::vector<HouseholdList> *, Counter<GenericParams> *, Random *);
+	double getChiSquareChange(const std::map<int, int> &, const std::vector<double> &, const std::vector<double> &) const;
+	Pool getFitPersonPool() const;
 
 	template<class T>
-	bool checkFit(const Marginal *, const T *, int);
+	bool checkFit(const Marginal *, const T *, int, bool);
 	
 	void gofLog(double, int, int);
 	
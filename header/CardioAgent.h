@@ -9,13 +9,13 @@
 
 #include "Agent.h"
 #include "CardioParams.h"
+#include "Random.h"
 
 //#include "Parameters.h"
 
 template<class GenericParams>
 class PersonPums;
 
-class Random;
 class CardioCounter;
 
 const double ldl_thres = 130.0;
@@ -24,6 +24,12 @@ const int statin_age_min = 40;
 const int statin_age_max = 75;
 const int num_years = 10;
 
+//random streams of an agent with common random numbers
+const int tax_stream = 0;
+const int statin_stream = 1;
+const int death_stream = 2;
+const int num_streams = 3;
+
 class CardioAgent : public Agent<CardioParams>
 {
 public: 
@@ -47,10 +53,12 @@ public:
 	void setNHANESOrigin(short int);
 	void setNHANESEduCat(short int);
 	void setRiskFactors(short int, EET::RiskFactors);
+	void setCounter(CardioCounter *);
+	void setRandom(Random *);
 
 	void update(int, int, int, int, bool);
-	void computeTenYearCHDRisk(std::string);
-	void processChdEvent(int, int, int, int, bool);
+	void setTenYearCHDRisk(std::string, double, double);
+	int processChdEvent(std::string, int);
 	void resetAttributes();
 
 	short int getNHANESAgeCat() const;
@@ -69,7 +77,10 @@ public:
 	std::string getRiskState() const;
 
 	double getRiskFactor(int) const;
+	const EET::RiskFactors *getRiskFactors() const;
 	double getPredictedCHDProbability() const;
+	double getBaselineTotalCHDRisk() const;
+	double getBaselineFatalCHDRisk() const;
 
 	double getMeanAge(std::string) const;
 	double getMeanHDL(std::string) const;
@@ -80,12 +91,11 @@ public:
 	double getPercentHTN(std::string) const;
 
 	bool isDead() const;
+	bool isRiskChanged() const;
 	bool isOnStatin() const;
 	bool isStatinQualified() const;
 	
 private:
-	void computeFraminghamCHDRisk(std::string);
-	void computeScoreFatalCHDRisk(std::string);
 	void computeRiskFactorDifference(std::string);
 
 	void updateAge();
@@ -112,18 +122,15 @@ private:
 
 	void deathFatalChd(std::string, int);
 
+	void resetRandomStreams();
+	double drawUniform(int);
+	int drawInt(int, int, int);
+
 	bool isNewRiskGreater(EET::RiskFactors);
+	bool isCHDRiskInputChanged(const EET::RiskFactors &) const;
 	
-	double getWeightedSumFramingham(int);
-	double getWeightedSumScore();
 	double getSumRisks(EET::RiskFactors);
 	
-	EET::Framingham getBetaFHS();
-	EET::Score getBetaScore();
-
-	double getTenYrSurvivalFramingham();
-	double getTenYrTotalCHDSurvivalARIC();
-	double getTenYrFatalCHDSurvivalARIC();
 	double getPercentChangeSmoking(int);
 	double getSmokingProbability(bool, double, int);
 	double getStatinUptakeProbability();
@@ -141,6 +148,10 @@ private:
 	CardioCounter *counter;
 	Random *random;
 
+	bool commonRandom;
+	unsigned int randomKey;
+	RandomStream streams[num_streams];
+
 	short int initAge;
 	short int nhanes_ageCat, nhanes_ageCat3;
 	short int nhanes_org;
@@ -150,8 +161,10 @@ private:
 	EET::RiskFactors chart, initChart;
 
 	double pTotalCHD, pFatalCHD;
+	double initPTotalCHD, initPFatalCHD;
 	
 	bool dead;
+	bool riskChanged; //true if inputs of CHD risk equations changed since last reset
 	short int deathYear;
 };
 
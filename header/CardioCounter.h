@@ -9,14 +9,57 @@
 class CardioAgent;
 class CardioParams;
 
+/*
+* @brief Streaming count, mean and sum of squared deviations (Welford)
+*/
+struct RunningStat
+{
+	long count;
+	double mean;
+	double m2;
+
+	RunningStat() : count(0), mean(0), m2(0) 
+	{
+	}
+
+	void add(double x)
+	{
+		count++;
+		double delta = x - mean;
+		mean += delta/count;
+		m2 += delta*(x - mean);
+	}
+
+	void merge(const RunningStat &s)
+	{
+		if(s.count == 0)
+			return;
+
+		long n = count + s.count;
+		double delta = s.mean - mean;
+		mean += delta*s.count/n;
+		m2 += s.m2 + delta*delta*((double)count*s.count/n);
+		count = n;
+	}
+
+	double variance() const
+	{
+		return (count > 1) ? m2/(count-1) : 0;
+	}
+};
+
 class CardioCounter : public Counter<CardioParams>
 {
 public:
 	typedef std::pair<double, double> PairDouble;
 	typedef std::pair<int, int> PairInts;
 	typedef std::map<std::string, double> MapStringDbl;
-	typedef std::map<std::string, std::vector<double>> CHDRiskScores, IncomeByRace;
-	typedef std::map<std::string, std::map<std::string, CHDRiskScores>> CHDRisksRaceGender;
+	typedef std::map<std::string, std::vector<double>> IncomeByRace;
+	typedef std::vector<RunningStat> CHDRiskScores; //by race-gender type code
+	typedef std::map<std::string, CHDRiskScores> CHDRisksRaceGender;
+	typedef std::vector<std::vector<double>> SumRiskFactors; //by type code and risk factor
+	typedef std::map<std::string, SumRiskFactors> MeanRiskTable; //by time frame
+	typedef std::map<std::string, std::vector<double>> MeanWeightedSums; //by time frame and race-gender type code
 	typedef std::map<std::string, std::map<int, double>> RiskFacMap;
 	typedef std::map<std::string, RiskFacMap> MeanRiskFactors, RiskFactorDiff;
 	typedef std::map<std::string, std::map<std::string, RiskFacMap>> TotalRiskFactors, StdDevRiskFac;
@@ -34,6 +77,12 @@ public:
 	virtual ~CardioCounter();
 
 	void initialize();
+	void addStatinsUsage(std::string, std::string, int, int, int, bool, int);
+	void initShard(const CardioCounter &);
+	void initScenario(const CardioCounter &);
+	void mergeOutcomes(const CardioCounter &);
+	void merge(const CardioCounter &);
+	using Counter<CardioParams>::merge;
 
 	void clearRiskFactor();
 	void clearCHDRisks(std::string);
@@ -44,12 +93,14 @@ public:
 	//void resetPersonCount(std::string);
 
 	//CVD model
+	void addRaceGenderCount(int, int);
+	void addRaceGenderEduCount(int, int, int);
 	void addRiskFactorCount(std::string);
 	void addRiskFactorDifference(std::string, std::string, int, double);
-	void addTenYearTotalCHDRisk(std::string, std::string, std::string, double);
-	void addTenYearFatalCHDRisk(std::string, std::string, std::string, double);
+	void addTenYearTotalCHDRisk(std::string, int, double);
+	void addTenYearFatalCHDRisk(std::string, int, double);
 	void addIncome(std::string, double);
-	void addRiskFactors(CardioAgent *, std::string, std::string);
+	void addRiskFactors(CardioAgent *);
 	void addStatinsUsage(CardioAgent *, std::string, std::string, int, int, int, bool);
 	void addChdDeaths(std::string, std::string, std::string);
 	void addYearsLifeLost(std::string, std::string, std::string, double);
@@ -63,22 +114,29 @@ public:
 	void sumOutcomes(std::string);
 
 	double getMeanRiskFactor(std::string, std::string, int);
+	double getMeanRiskFactor(std::string, int, int) const;
+	double getMeanWeightedSum(std::string, int) const;
 	double getChdDeaths(std::string, int);
 
+	static int getTypeCode(int, int);
+	static int getTypeCode(int, int, int);
+
 	//void outputRiskFactorPercent();
 
 private:
 	void initRiskFacCounter();
+	virtual void registerAgentTypes();
 
-	void accumulateRiskFacs(CardioAgent *, std::string, std::string);
+	void accumulateRiskFacs(CardioAgent *, int);
 	RiskFacMap computeMean();
-	void computeMean(RiskFacMap &, std::string);
+	void computeMean(RiskFacMap &, std::string, int);
+	void computeMeanTable(std::string);
 
 	void sumMeanRiskFactors(std::string);
 	void sumStdDevRiskFactors(std::string);
 	void sumTenYearTotalCHDRisk(std::string);
 	void sumTenYearFatalCHDRisk(std::string);
-	void sumTenYearCHDRisk(std::map<std::string, CHDRiskScores> &, TotalCHDScores &, std::string, std::string);
+	void sumTenYearCHDRisk(const CHDRiskScores &, TotalCHDScores &, std::string, std::string);
 
 	//CVD model outputs
 
@@ -101,13 +159,20 @@ private:
 
 	void clearRiskFactorCounter();
 	void clearCHDRiskCounter(std::string);
+	void clearOutcomeCounter();
 
 	std::shared_ptr<CardioParams> param;
 
+	//person type codes of agents by race-gender(-education) type code (see getTypeCode)
+	std::vector<int> m_agentTypeCodes;
+
 	//Counters for EET model
 	IncomeByRace m_incomeByRace;
-	RiskFacMap m_sumRiskFac; //, m_meanRiskFac;
+	SumRiskFactors m_sumRiskFac; //, m_meanRiskFac;
+	std::vector<int> m_sumRiskFacCount;
 	MeanRiskFactors m_meanRiskFac;
+	MeanRiskTable m_meanRiskTable;
+	MeanWeightedSums m_meanWeightedSum;
 	RiskFactorDiff m_sumDiffRiskFac;
 	TypeMap m_riskFacCount;
 	CHDRisksRaceGender m_totalChdRiskScore, m_fatalChdRiskScore;
@@ -18,6 +18,7 @@
 #include <tuple>
 
 #include "CardioAgent.h"
+#include "CardioPopulation.h"
 #include "PopBrewer.h"
 
 class CardioParams;
@@ -48,6 +49,30 @@ public:
 
 	typedef std::tuple<double, int, EET::RiskFactors> WeightStrataRiskTuple;
 	typedef std::map<std::string, std::vector<WeightStrataRiskTuple>> AgentRiskTuple;
+
+	/*
+	* @brief Intervention scenario waiting to be run
+	*/
+	struct SubModel
+	{
+		std::string interventionName;
+		int interventionId;
+		int taxType, statinsType;
+		int interventionYears;
+		bool isEducationPresent;
+	};
+
+	/*
+	* @brief Agents, counter, random stream and risk arrays a scenario runs on
+	*/
+	struct Scenario
+	{
+		AgentList *agents;
+		CardioCounter *count;
+		Random *random;
+		CardioPopulation *population;
+		int numThreads;
+	};
 	
 	CardioModel();
 	CardioModel(const char *, const char *, int, int);
@@ -65,9 +90,13 @@ public:
 	void clearList();
 
 private:
+	CardioModel(const CardioParams &, unsigned int);
+
+	void runTrial(Area<CardioParams> *, int);
 	void createPopulation(Area<CardioParams> *);
 	void computeEducationDifference();
 	void setRiskFactors();
+	void assignRiskFactorsBlock(const AgentList *, const std::vector<size_t> *, const std::vector<unsigned int> *, int, int, CardioCounter *);
 	void runModel();
 
 	void educationIntervention(int, bool);
@@ -77,13 +106,17 @@ private:
 	void taxStatinsIntervention(int, bool);
 
 	void runSubModels(std::string, int, int, int, int, bool);
+	void runSubModels();
+	void runSubModels(Scenario &, const SubModel &);
+	void runScenarios(size_t, size_t, const std::vector<unsigned int> *, std::vector<CardioCounter> *);
 
-	void computeTenYearCHDRisk(std::string);
-	void executeIntervention(int, int, int, int, bool);
-	void processChdEvents(int, int, int, bool);
+	void computeTenYearCHDRisk(Scenario &, std::string);
+	void recordCHDRiskBlock(Scenario *, std::string, size_t, size_t, unsigned int, CardioCounter *);
+	void executeIntervention(Scenario &, int, int, int, int, bool);
+	void processChdEvents(Scenario &, int, int, int, bool);
 
-	void resetAttributes();
-	void resetPersonCounter();
+	void resetAttributes(Scenario &);
+	void resetPersonCounter(CardioCounter *);
 
 	void rounding(std::vector<PairDD>&, double &);
 	double rounding(std::vector<WeightStrataRiskTuple>&, double &);
@@ -100,7 +133,10 @@ private:
 	Random *random;
 
 	AgentList agentList;
-	AgentPtr agentsPtrMap;
+
+	CardioPopulation population;
+	std::vector<SubModel> subModels;
+	bool baselineRisk; //true if 10-year CHD risk of the baseline population is computed
 
 };
 #endif
\ No newline at end of file
@@ -81,6 +81,19 @@ namespace EET
 		short int isSmoker;
 	};
 
+	/*Risk factors sorted by sum of total cholesterol and systolic BP (see CardioAgent::getSumRisks)*/
+	struct SortedRisks
+	{
+		std::vector<double> sumRisks;
+		std::vector<RiskFactors> risks;
+	};
+
+	/*Candidate risk factors of an agent type and risk strata after change in smoking status*/
+	struct ReplacementRisks
+	{
+		SortedRisks all;
+		SortedRisks formerSmoker, nonSmoker;
+	};
 	
 }
 
@@ -102,6 +115,7 @@ public:
 	
 	typedef std::map<std::string, std::map<int, std::map<PairDD, WeightRiskPair>>> RiskFactorsMap2;
 	typedef std::map<std::string, std::vector<double>> WeightsByAgentType;
+	typedef std::vector<EET::ReplacementRisks> ReplacementRiskTable;
 
 	CardioParams();
 	CardioParams(const char*, const char*, const int, const int);
@@ -120,6 +134,9 @@ public:
 	const VectorCumulativeProbability *getRiskStrataCumulativeProbability(std::string);
 	const AgentStrataRiskMap *getRiskFactorMap();
 	const VectorWeightRisks *getRiskFactorByStrata(std::string, int);
+	const EET::ReplacementRisks *getReplacementRisks(int, int, int, int, int) const;
+	int getRiskTypeCode(int, int, int, int) const;
+	int getNumRiskTypes() const;
 	const EET::RiskState *getRiskMatrix(int);
 	const int getRiskStrata(std::string);
 	const double getPercentEduDifference(std::string);
@@ -134,6 +151,7 @@ private:
 	void readNHANESRiskFactors();
 	void addRiskFactors(RiskFactorsMap2 &, WeightsByAgentType &);
 	void computeRiskFactorSelectionProbability(WeightsByAgentType &);
+	void computeReplacementRisks();
 
 	void readRiskFactorMatrix();
 	void readFraminghamCoefficients(); 
@@ -145,6 +163,7 @@ private:
 	ProbMap m_riskStrataProb;
 	RiskStrataCumulativeProbability m_pRiskStrataEdu;
 	AgentStrataRiskMap m_riskFactors;
+	ReplacementRiskTable m_replacementRisks;
 	RiskMatrix m_riskMatrix;
 	MapInt m_riskStrata;
 	EET::Cardio cardioParams;
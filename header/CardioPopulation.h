@@ -0,0 +1,75 @@
+#ifndef __CardioPopulation_h__
+#define __CardioPopulation_h__
+
+#include <memory>
+#include <vector>
+#include <map>
+#include <tuple>
+#include "CardioParams.h"
+
+class CardioAgent;
+class CardioCounter;
+
+/*
+* @brief Coefficients of 10-year CHD risk equations for one race-gender type
+*/
+struct CHDRiskCoefficients
+{
+	EET::Framingham beta;
+	EET::Score scoreBeta;
+
+	double meanSum;          //Framingham weighted sum at mean risk factors of the type
+	double meanTchols, meanSbp;
+	double survival, fatalSurvival;
+	double maxAge;
+};
+
+/*
+* @brief Struct-of-arrays snapshot of the risk factors used by the Framingham and SCORE
+*        equations, one slot per agent of CardioModel::agentList. Risk of all agents is
+*        computed with batch loops over contiguous arrays instead of per-agent method calls.
+*        With profile compression, agents sharing identical inputs of the risk equations
+*        (race-gender type, capped age and chart values) share one slot, so risk is evaluated
+*        once per distinct profile and read back by every member.
+*        Gathering only changed agents, agents whose risk inputs are unchanged since the
+*        baseline get no slot and read back their baseline risk instead.
+*/
+class CardioPopulation
+{
+public:
+	typedef std::vector<CardioAgent *> AgentList;
+	typedef std::tuple<int, double, double, double, double, double, double> ProfileKey;
+	typedef std::map<ProfileKey, int> ProfileMap;
+
+	CardioPopulation();
+	virtual ~CardioPopulation();
+
+	void setCoefficients(std::shared_ptr<CardioParams>, CardioCounter *);
+	void gather(const AgentList *, bool, bool);
+	void computeCHDRisk(size_t, size_t);
+	void clear();
+
+	size_t size() const;
+	size_t getNumAgents() const;
+	double getTotalCHDRisk(size_t) const;
+	double getFatalCHDRisk(size_t) const;
+
+private:
+	void computeTotalCHDRisk(size_t, size_t);
+	void computeFatalCHDRisk(size_t, size_t);
+
+	std::vector<CHDRiskCoefficients> coefficients; //by race-gender type code
+
+	std::vector<int> profile; //slot of each agent, or -(k+1) for k-th agent with baseline risk
+	std::vector<double> baseTotalCHD, baseFatalCHD;
+	ProfileMap profileIdx;
+
+	//one entry per slot (agent, or distinct profile if compressed)
+	std::vector<int> typeCode;
+	std::vector<double> age, tchols, hdl, sbp;
+	std::vector<double> htnMed, smokeStat;
+
+	std::vector<double> pTotalCHD, pFatalCHD;
+};
+
+#endif //__CardioPopulation_h__
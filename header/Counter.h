@@ -9,6 +9,8 @@
 #include <memory>
 #include <fstream>
 #include <cmath>
+#include <cstdint>
+#include <algorithm>
 
 #define WEEKS_IN_YEAR 52
 #define DAYS_IN_WEEK 7
@@ -18,19 +20,30 @@ class Counter
 {
 public:
 	typedef std::map<std::string, std::vector<bool>> TypeMap;
+	typedef std::map<std::string, int> TypeIndexMap;
+	typedef std::vector<uint64_t> CountArray;
 	typedef std::vector<std::string> Pool;
 
 	Counter();
 	virtual ~Counter();
 
-	int getPersonCount(std::string) const;
-	int getHouseholdCount(std::string) const;
+	int getPersonCount(const std::string &) const;
+	int getHouseholdCount(const std::string &) const;
+	int getPersonTypeCode(const std::string &) const;
+	int getHouseholdTypeCode(const std::string &) const;
+	bool hasPersonType(const std::string &) const;
 
 	void initialize();
+	void initCounter(std::shared_ptr<GenericParams>);
+	void initShard(const Counter<GenericParams> &);
+	void merge(const Counter<GenericParams> &);
 
-	void addHouseholdCount(std::string);
+	void addHouseholdCount(const std::string &);
+	void addHouseholdTypeCount(int);
+	void addPersonTypeCount(int);
+	void removePersonTypeCount(int);
 	void addPersonCount(const char *);
-	void addPersonCount(std::string);
+	void addPersonCount(const std::string &);
 	void addPersonCount(int, int);
 	void addPersonCount(std::string, std::string);
 
@@ -39,13 +52,22 @@ public:
 protected:
 	void initHouseholdCounter(std::shared_ptr<GenericParams>);
 	void initPersonCounter(std::shared_ptr<GenericParams>);
+	virtual void registerAgentTypes();
 	
 	void clearMap(TypeMap &);
+	int registerPersonType(const std::string &);
+	int getTableCode(const std::vector<int> &, int, int, int) const;
 
 	void outputHouseholdCounts(std::shared_ptr<GenericParams>, std::string);
 	void outputPersonCounts(std::shared_ptr<GenericParams>, std::string);
 
-	TypeMap m_personCount, m_householdCount;
+	//counts are stored densely by type code; codes of household and person pools 
+	//follow pool order, followed by agent types of the model (see registerAgentTypes).
+	//Other person types get codes when first counted.
+	TypeIndexMap m_personIdx, m_householdIdx;
+	CountArray m_personCount, m_householdCount;
+	Pool m_personTypes; //person type by code
+	size_t m_numFixedTypes; //number of person types registered at initPersonCounter
 
 };
 #endif __Counter_h__
\ No newline at end of file
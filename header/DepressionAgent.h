@@ -19,6 +19,7 @@ namespace Depression
 	const double second_q = 0.5;
 	const double third_q = 0.75;
 	const double fourth_q = 1.0;
+	const int num_quartiles = 4;
 }
 
 class DepressionAgent : public Agent<DepressionParams>
@@ -38,10 +39,13 @@ public:
 	void setIncomeToPovertyRatio(double, int, int, int);
 	void setDepressionType(short int);
 	void setDepressionSymptoms();
+	void setCounter(DepressionCounter *);
+	void setRandom(Random *);
 
 	std::string getAgentID() const;
 	short int getAgeCat() const;
 	short int getDepressionType() const;
+	short int getIncomePovertyRatioTag() const;
 
 	std::string getAgentType1() const;
 	std::string getAgentType2() const;
@@ -20,15 +20,30 @@ public:
 	virtual ~DepressionCounter();
 
 	void initialize();
+	void initShard(const DepressionCounter &);
+	void merge(const DepressionCounter &);
+	using Counter<DepressionParams>::merge;
+	void addSexAgeCatCount(int, int);
+	void addIncomePovertyCount(int, int, int);
+	void addDepressionTypeCount(int, int, int, int);
+	void addSymptomsQuartileCount(int, int, int, int, int);
+
 	void computeOutcomes(std::string);
 
 	void output(std::string);
 	void clear();
 private:
+	virtual void registerAgentTypes();
+	int getSexAgeCatRow(int, int) const;
+
 	void computePrevalence(std::string);
 	void outputPrevalence(std::string);
 
 	std::shared_ptr<DepressionParams> param;
+
+	//person type codes of agents by sex and age cat (rows) and income to poverty ratio, 
+	//depression type and symptoms quartile (columns), see registerAgentTypes
+	std::vector<int> m_sexAgeCatCodes, m_ipRatioCodes, m_depressionTypeCodes, m_symptomsCodes;
 	HashMap m_depressionPrevalence, m_popBySexAgeDepression;
 };
 #endif
\ No newline at end of file
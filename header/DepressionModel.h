@@ -52,6 +52,7 @@ private:
 	void createPopulation(Area<DepressionParams> *);
 	void computeWageGap();
 	void setDepressionType(AgentMap *, std::string);
+	void setDepressionTypeBlock(const std::vector<DepressionAgent *> *, const VecPairDblInt *, size_t, size_t, unsigned int, DepressionCounter *);
 	void execute(std::string);
 
 	bool checkFit(const VecPairDblInt*, std::string[], std::string, int, int);
@@ -37,7 +37,10 @@ public:
 	short int getHouseholdIncCat() const;
 	short int getHHTypeBySize() const;
 	std::vector<PersonPums<GenericParams>> getPersons() const;
+	const std::vector<PersonPums<GenericParams>> &getPersonList() const;
+	const std::vector<int> &getPersonTypes() const;
 
+	void setPersonTypes(const std::map<std::string, int> &poolIdx);
 	void clearPersonList();
 	
 private:
@@ -61,6 +64,7 @@ private:
 	short int totalPersons;
 
 	std::vector<PersonPums<GenericParams>> hhPersons;
+	std::vector<int> personTypeCodes;
 };
 
 #endif __HouseholdPums_h__
\ No newline at end of file
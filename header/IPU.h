@@ -2,6 +2,7 @@
 #define __IPU_h__
 
 #include <iostream>
+#include <fstream>
 #include <iomanip>
 #include <armadillo>
 #include <memory>
@@ -9,9 +10,13 @@
 #include <map>
 #include <string>
 #include <numeric>
+#include <algorithm>
+#include <tuple>
 
 #include "HouseholdPums.h"
 #include "PersonPums.h"
+#include "ElapsedTime.h"
+#include "AliasTable.h"
 
 //class HouseholdPums;
 
@@ -31,14 +36,40 @@ public:
 	typedef std::map<std::string, double> CountsMap;
 	
 	typedef std::map<double, HouseholdPums<GenericParams>> HouseholdsMap;
+	typedef std::map<double, double> WeightsMap;
+	typedef std::map<std::string, AliasTable> AliasMap;
+	typedef std::pair<double, int> PairDblInt;
+	typedef std::map<std::string, std::vector<PairDblInt>> ReplicationMap;
+
+	//fixed-size record of binary convergence trace
+	struct TraceRecord
+	{
+		int iteration;
+		int num_cols;
+		double gamma;
+		double delta;
+		double wall_ms;
+	};
 
 	IPU(HouseholdsMap *, const std::vector<double>&, bool);
 	virtual ~IPU();
 	
 	void start();
+	void setInitialWeights(const WeightsMap *, bool);
+	void setSolver(short int);
+	void setTolerance(double);
+	void setMaxIterations(int);
+	void setTrace(std::string);
+	void setExportProbabilities(bool);
+	void setIntegerize(bool);
 
 	bool success();
+	bool cornerSolution() const;
+	const WeightsMap *getWeights() const;
+	const std::vector<std::string> *getPrunedColumns() const;
 	const ProbMap *getHHProbability() const;
+	const AliasMap *getHHAliasTables() const;
+	const ReplicationMap *getHHReplications() const;
 	double getHHCount(std::string) const;
 	void clearMap();
 	
@@ -46,11 +77,24 @@ private:
 
 	void initialize();
 	void solve(int, int);
+	void solveRaking(int, int);
+	double getRakingResidual(const std::vector<int> &, vec &);
 	void mapIndexByType(int &);
 	void mapNonZeroRowIndex(int);
+	void pruneColumns(int);
+	std::vector<int> getActiveColumns(int) const;
 	double getColWeightSum(int);
+	void groupWeightsByType(std::map<std::string, std::vector<PairDD>> &);
+	void computeAliasTables();
 	void computeProbabilities();
 	void roundWeights(std::map<std::string, double> &);
+	void integerizeWeights();
+	void seedWeights();
+	void saveWeights();
+	void truncateConstraints();
+	void openTrace();
+	void closeTrace();
+	void logIteration(int, int, double, double);
 	void clear();
 
 	std::shared_ptr<HouseholdsMap> m_households;
@@ -58,14 +102,29 @@ private:
 	vec cons;
 	vec weights;
 	double eps;
+	int maxIterations;
 	bool printOutput;
 	bool ipu_success;
+	bool corner_solution;
+	bool exportProbabilities;
+	bool integerize;
+	short int solverType;
 
 	IndexMap m_idx;
 	ColIndexMap m_nonZeroIdx;
+	std::vector<int> m_activeCols;
+	std::vector<std::string> m_prunedCols;
 	//ProbMap m_hhProbs;
 	ProbMap m_hhProbs;
 	CountsMap m_hhCount;
+	AliasMap m_aliasTables;
+	ReplicationMap m_hhReplications;
+	WeightsMap m_initWeights;
+	WeightsMap m_weights;
+
+	std::string traceFilename;
+	std::ofstream traceFile;
+	ElapsedTime solveTimer, printTimer;
 };
 
 #endif __IPU_h__
@@ -11,6 +11,7 @@
 #include <map>
 #include "PersonPums.h"
 #include "HouseholdPums.h"
+#include "AliasTable.h"
 
 //class Parameters;
 class County;
@@ -36,15 +37,24 @@ public:
 	typedef std::map<double, HouseholdPums<GenericParams>> HouseholdsMap;
 	typedef std::multimap<int, County> CountyMap;
 	typedef std::map<std::string, double> ConsPersonMap;
+	typedef std::map<double, double> WeightsMap;
+	typedef std::map<std::string, AliasTable> AliasMap;
+	typedef std::map<std::string, std::vector<std::pair<double, int>>> ReplicationMap;
 
 	IPUWrapper(std::shared_ptr<GenericParams>, ACSEstimates*, CountyMap*);
 	virtual ~IPUWrapper();
 
 	void startIPU(std::string, std::string, int, bool);
+	void setWarmStart(const WeightsMap *, bool);
 	void clearHHPums();
 
 	bool successIPU();
+	bool cornerSolutionIPU() const;
+	const WeightsMap *getHouseholdWeights() const;
+	const Columns *getPrunedColumns() const;
 	const ProbMap *getHouseholdProbability() const;
+	const AliasMap *getHouseholdAliasTables() const;
+	const ReplicationMap *getHouseholdReplications() const;
 	const HouseholdsMap *getHouseholds() const;
 	double getHouseholdCount(std::string) const;
 	const Marginal *getConstraints() const;
@@ -99,6 +109,9 @@ private:
 	std::vector<int> m_size;
 
 	Marginal ipuCons;
+
+	WeightsMap m_warmWeights;
+	bool warmCorner;
 };
 
 #endif 
\ No newline at end of file
@@ -0,0 +1,61 @@
+#ifndef __ParallelBlocks_h__
+#define __ParallelBlocks_h__
+
+#include <vector>
+#include <thread>
+#include <limits>
+#include "Random.h"
+
+/*
+* @brief Runs block(index) for each of num_blocks blocks, each on its own thread, and waits
+*        for all of them. A single block runs on the calling thread.
+* @param num_blocks Number of blocks
+* @param block Function called with the index of the block
+*/
+template<class Block>
+void runBlocks(int num_blocks, Block block)
+{
+	if(num_blocks == 1)
+	{
+		block(0);
+		return;
+	}
+
+	std::vector<std::thread> workers;
+	for(int t = 0; t < num_blocks; ++t)
+		workers.push_back(std::thread(block, t));
+
+	for(size_t t = 0; t < workers.size(); ++t)
+		workers[t].join();
+}
+
+/*
+* @brief Runs block(index, seed, shard) for each of num_blocks blocks in parallel (see above).
+*        Each block gets a thread-local counter (shard) initialized from master and a seed
+*        drawn from random in block order (0 if random is NULL). Shards are merged into master
+*        in block order once all blocks are complete, so results do not depend on scheduling.
+* @param num_blocks Number of blocks
+* @param random Random stream seeds of the blocks are drawn from
+* @param master Counter the shards are merged into
+* @param block Function called with the index, seed and shard of the block
+*/
+template<class Shard, class Master, class Block>
+void runBlocks(int num_blocks, Random *random, Master *master, Block block)
+{
+	std::vector<Shard> shards(num_blocks);
+	std::vector<unsigned int> seeds(num_blocks, 0);
+
+	for(int t = 0; t < num_blocks; ++t)
+	{
+		if(random != NULL)
+			seeds[t] = random->random_int(1, std::numeric_limits<int>::max());
+		shards[t].initShard(*master);
+	}
+
+	runBlocks(num_blocks, [&](int t) { block(t, seeds[t], &shards[t]); });
+
+	for(int t = 0; t < num_blocks; ++t)
+		master->merge(shards[t]);
+}
+
+#endif //__ParallelBlocks_h__
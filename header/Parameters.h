@@ -20,6 +20,9 @@
 #define POP_MENTAL_HEALTH 3
 #define NUM_RISK_STRATA 32
 
+#define IPU_UPDATING 1
+#define IPU_RAKING 2
+
 
 class Parameters
 {
@@ -65,6 +68,18 @@ public:
 	double getAlpha() const;
 	double getMinSampleSize() const;
 	int getMaxDraws() const;
+	short int getIPUSolver() const;
+	double getIPUTolerance() const;
+	int getIPUMaxIterations() const;
+	bool traceIPU() const;
+	bool exportIPUProbabilities() const;
+	int getNumThreads() const;
+	int getNumTrialThreads() const;
+	unsigned int getSeed() const;
+	bool repairFit() const;
+	bool integerizeWeights() const;
+	bool compressProfiles() const;
+	bool commonRandomNumbers() const;
 	short int getSimType() const;
 	short int getGeoType() const;
 	bool isStateLevel() const;
@@ -86,6 +101,8 @@ protected:
 	void readAgeGenderMappingFile();
 	void readHHIncomeMappingFile();
 	void readOriginListFile();
+	void readIPUParamsFile();
+	void readRunParamsFile();
 
 	void createHouseholdPool();
 	void createPersonPool();
@@ -114,6 +131,18 @@ protected:
 
 	double alpha, minSampleSize;
 	int max_draws;
+	short int ipuSolver;
+	double ipuTolerance;
+	int ipuMaxIterations;
+	bool ipuTrace;
+	bool ipuExportProbs;
+	int numThreads;
+	int numTrialThreads;
+	unsigned int seed;
+	bool fitRepair;
+	bool integerWeights;
+	bool profileCompression;
+	bool commonRandom;
 	short int simType;
 	short int geoLevel;
 	bool output;
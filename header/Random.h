@@ -2,6 +2,7 @@
 #define __Random_h__
 
 #include <ctime>
+#include <cstdint>
 #include <boost/random/uniform_real_distribution.hpp>
 #include <boost/random/mersenne_twister.hpp>
 #include <boost/random/variate_generator.hpp>
@@ -13,6 +14,7 @@ class Random
 {
 public:
 	Random();
+	Random(unsigned int);
 	virtual ~Random();
 
 	double uniform_real_dist();
@@ -26,4 +28,25 @@ public:
 private:
 	boost::mt19937 rng;
 };
+
+/*
+* @brief Small counter-based random stream (splitmix64) identified by a key and a stream index.
+*        Reseeding with the same key and stream replays the same sequence, so an agent 
+*        can draw identical random numbers in every intervention scenario.
+*/
+class RandomStream
+{
+public:
+	RandomStream();
+
+	void seed(unsigned int, int);
+
+	double uniform_real_dist();
+	int random_int(int, int);
+
+private:
+	uint64_t next();
+
+	uint64_t state;
+};
 #endif
\ No newline at end of file
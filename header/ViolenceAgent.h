@@ -23,6 +23,7 @@
 #define SECOND_Q 0.50
 #define THIRD_Q 0.75
 #define FOURTH_Q 1.0
+#define NUM_QUARTILES 4
 
 //PTSD treatments
 #define NUM_TREATMENT 3
@@ -66,6 +67,8 @@ public:
 	void excecuteRules(int);
 
 	void setAgentIdx(std::string);
+	void setCounter(ViolenceCounter *);
+	void setRandom(Random *);
 	void setAgeCat();
 	void setAgeCat2();
 	void setNewOrigin();
@@ -88,7 +91,7 @@ public:
 	double getInitPTSDx() const;
 	double getPTSDx(int) const;
 	//double getPTSDx(PairDD) const;
-	double getPTSDx(Tuple, std::string) const;
+	double getPTSDx(Tuple) const;
 	double getPtsdCutOff() const;
 	bool getPTSDstatus(int) const;
 	bool getCBTReferred() const;
@@ -57,6 +57,8 @@ public:
 	typedef std::map<std::string, std::map<std::string, double>> MapStringDbls;
 	
 	typedef std::map<int, Outcomes> MapOutcomes;
+	typedef std::vector<Outcomes> VecOutcomes;
+	typedef std::vector<int> VecInts;
 	typedef std::vector<std::string> Pool;
 	typedef std::pair<double, double> Pair;
 	typedef std::vector<ViolenceAgent*> AgentListPtr;
@@ -69,9 +71,19 @@ public:
 	virtual ~ViolenceCounter();
 
 	void initialize();
+	void initShard(const ViolenceCounter &);
+	void merge(const ViolenceCounter &);
+	void mergeOutcomes(const ViolenceCounter &);
+	using Counter<ViolenceParams>::merge;
 	void clear();
 	void output(std::string, std::string);
 
+	void addAgeCatCount(int);
+	void addHoursWatchedCount(int, int);
+	void addSourceNewsCount(int, int);
+	void addPtsdSourceNewsCount(int, int);
+	void addSocialMediaHoursCount(int, int);
+	void addPtsdxQuartileCount(int, int, int, int, int);
 	void addPtsdCount(int, int, int);
 	void addPrevalence(int);
 	void addPrevalence(MapPair *, std::string, std::string);
@@ -98,6 +110,7 @@ public:
 
 private:
 	void initPtsdCounter();
+	virtual void registerAgentTypes();
 	void initTreatmentCounter(int);
 
 	void computePrevalence(int, int);
@@ -124,16 +137,23 @@ private:
 	std::shared_ptr<ViolenceParams> param;
 
 	double totalPrevalence;
-	//Counters for Mass Violence Model1(PTSD and PTSD resolved)
+
+	//person type codes of agents by age cat2 (rows) and media use (columns), see registerAgentTypes
+	VecInts m_ageCatCodes, m_hoursWatchedCodes, m_sourceNewsCodes, m_ptsdSourceNewsCodes, m_socialMediaCodes;
+	//person type codes of PTSDx quartiles by sex, age cat, PTSD type (rows) and PTSD case, quartile (columns)
+	VecInts m_ptsdxCodes;
+
+	//Counters for Mass Violence Model1(PTSD and PTSD resolved), indexed by tick (or year)
+	//and preallocated for all ticks at initialize()
 	int nonPtsdCountSC;
-	MapInts m_ptsdCount[NUM_TREATMENT][NUM_PTSD], m_ptsdResolvedCount[NUM_TREATMENT][NUM_PTSD];
-	MapDbls m_totPrev[NUM_TREATMENT][NUM_PTSD], m_totRecovery[NUM_TREATMENT][NUM_PTSD];
+	VecInts m_ptsdCount[NUM_TREATMENT][NUM_PTSD], m_ptsdResolvedCount[NUM_TREATMENT][NUM_PTSD];
+	VectorDbls m_totPrev[NUM_TREATMENT][NUM_PTSD], m_totRecovery[NUM_TREATMENT][NUM_PTSD];
 	
-	MapInts m_cbtReach[NUM_TREATMENT], m_sprReach[NUM_TREATMENT];
-	MapInts m_cbtCount, m_sprCount, m_ndCount; //overall count of CBT and SPR treatment
-	MapInts m_totCbt[NUM_TREATMENT][NUM_CASES], m_totSpr[NUM_TREATMENT][NUM_CASES];
+	VecInts m_cbtReach[NUM_TREATMENT], m_sprReach[NUM_TREATMENT];
+	VecInts m_cbtCount, m_sprCount, m_ndCount; //overall count of CBT and SPR treatment
+	VecInts m_totCbt[NUM_TREATMENT][NUM_CASES], m_totSpr[NUM_TREATMENT][NUM_CASES];
 	
-	MapOutcomes m_prevalence, m_recovery;
+	VecOutcomes m_prevalence, m_recovery;
 	MapDbls m_totDalys, m_totPtsdFreeWeeks, m_totCost, m_avgCost;
 	VectorDbls totalReach[NUM_TREATMENT];
 
@@ -70,6 +70,16 @@ public:
 	typedef std::map<std::string, PairDD> MapPair;
 	typedef std::map<std::string, Quadraple> MapQuadraple;
 
+	/*
+	* @brief Candidate friends of a bucket of agents (by origin, or by origin and education) 
+	*        indexed by age, so candidates can be drawn within an age window
+	*/
+	struct FriendPool
+	{
+		std::vector<AgentListPtr> byAge;
+	};
+	typedef std::map<std::string, FriendPool> FriendPoolMap;
+
 	ViolenceModel();
 	ViolenceModel(const char*, const char*, int, int);
 	virtual ~ViolenceModel();
@@ -106,8 +116,10 @@ public:
 	void clearList();
 
 private:
+	ViolenceModel(const ViolenceParams &, unsigned int);
 
-	void createPopulation();
+	void runTrial(Area<ViolenceParams> *, int, std::string);
+	void createPopulation(Area<ViolenceParams> *);
 	void groupAffectedAgents(std::string);
 	
 	void distributePtsdStatus();
@@ -116,12 +128,15 @@ private:
 	void distributePtsdStatus(AgentListMap *, std::string, int, int);
 
 	void runModel();
+	void executeRulesBlock(std::vector<Household> *, size_t, size_t, int, unsigned int, ViolenceCounter *, int *);
 
 	void createSchool(std::vector<Household>*);
 	void createAgentHashMap(AgentListMap *, ViolenceAgent *, int);
 
 	void createSocialNetwork(std::vector<Household>*, int);
-	void findFriends(AgentListMap *, ViolenceAgent *, int);
+	void createFriendPools(const AgentListMap *, FriendPoolMap *);
+	void findFriends(FriendPoolMap *, ViolenceAgent *, int);
+	bool findFriend(FriendPool *, ViolenceAgent *);
 
 	void distPrimaryPtsd();
 	void distSecondaryPtsd();
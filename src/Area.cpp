@@ -22,9 +22,17 @@
 #include "IPUWrapper.h"
 #include "ElapsedTime.h"
 #include "Random.h"
+#include "ParallelBlocks.h"
 #include "CardioModel.h"
 #include "ViolenceModel.h"
 #include "DepressionModel.h"
+#include <mutex>
+
+namespace
+{
+	//concurrent trials create agents from the same area and append to the same log
+	std::mutex gofLogMutex;
+}
 
 template class Area<ViolenceParams>;
 template class Area<CardioParams>;
@@ -34,6 +42,8 @@ template class Area<DepressionParams>;
 template void Area<CardioParams>::createAgents<CardioModel>(CardioModel *);
 template void Area<ViolenceParams>::createAgents<ViolenceModel>(ViolenceModel *);
 template void Area<DepressionParams>::createAgents<DepressionModel>(DepressionModel *);
+template void Area<CardioParams>::createAgents<CardioModel>(CardioModel *, unsigned int);
+template void Area<ViolenceParams>::createAgents<ViolenceModel>(ViolenceModel *, unsigned int);
 
 /*
 * @brief Default class constructor
@@ -202,6 +212,34 @@ int Area<GenericParams>::getCountyNum(std::string countyName) const
 template<class GenericParams>
 template <class T>
 void Area<GenericParams>::createAgents(T *model)
+{
+	createAgents(model, (unsigned int)time(NULL));
+}
+
+/*
+* @brief Initiate IPU to create agents. 
+*        Executes draw households to create households and agents
+* @param model Model for which agents are created
+* @param seed Seed of random stream of household draws
+*/
+template<class GenericParams>
+template <class T>
+void Area<GenericParams>::createAgents(T *model, unsigned int seed)
+{
+	createIPU();
+	
+	if(parameters->integerizeWeights())
+		replicateHouseholds(ipuWrapper, model);
+	else
+		drawHouseholds(ipuWrapper, model, seed);
+}
+
+/*
+* @brief Runs IPU for the area if it has not been run yet. IPU results are only read
+*        afterwards, so models creating agents concurrently must call this first.
+*/
+template<class GenericParams>
+void Area<GenericParams>::createIPU()
 {
 	if(ipuWrapper == NULL)
 	{
@@ -217,28 +255,31 @@ void Area<GenericParams>::createAgents(T *model)
 			exit(EXIT_SUCCESS);
 		}
 	}
-	
-	drawHouseholds(ipuWrapper, model);
 }
 
 /*
 * @brief Draws households from PUMS data set based on the computed probabilty (from IPU)
-*        of selecting households. Checks for the fit of the generated population using a 
-*        Chi-Square test. Households are drawn until the fit is satisfied.
+*        of selecting households, using alias tables (one O(1) draw per household). 
+*        With more than one thread, household types are drawn and counted in parallel 
+*        and the drawn households are added to the model afterwards. Checks for the fit 
+*        of the generated population using a Chi-Square test. If repair is enabled, a 
+*        poorly fitting draw is repaired by swapping households before it is discarded. 
+*        Households are drawn until the fit is satisfied.
 * @param ipuWrap IPUWrapper object
 * @param model Model for which population is created
+* @param seed Seed of random stream of household draws
 */
 template<class GenericParams>
 template <class T>
-void Area<GenericParams>::drawHouseholds(IPUWrapper<GenericParams> *ipuWrap, T *model)
+void Area<GenericParams>::drawHouseholds(IPUWrapper<GenericParams> *ipuWrap, T *model, unsigned int seed)
 {
 	std::cout << "Creating Households...\n" << std::endl;
 
 	double waitTime = 4000; //4 seconds wait time
 	ElapsedTime timer;
 
-	//Get computed probability for selecting households 
-	const ProbMap *prHouseholds = ipuWrap->getHouseholdProbability();
+	//Get alias tables for selecting households 
+	const AliasMap *aliasHouseholds = ipuWrap->getHouseholdAliasTables();
 
 	//Get PUMS households
 	const PUMSHouseholdsMap* m_householdsPums = ipuWrap->getHouseholds();
@@ -246,19 +287,15 @@ void Area<GenericParams>::drawHouseholds(IPUWrapper<GenericParams> *ipuWrap, T *
 	//Get Household and person level constraints
 	const Marginal *ipuCons = ipuWrap->getConstraints();
 
-	double num_households, randomP, hhProb, hhIdx;
+	double num_households, hhIdx;
 	std::string hhType;
 
 	bool fit_pop = false;
 	int num_draws = 0;
-	
-	std::vector<PersonPums<GenericParams>> tempPersons;
+	int num_threads = parameters->getNumThreads();
+	bool repair = parameters->repairFit();
 
-	std::string sex, ageCat, origin, eduAgeCat, edu;
-	std::string personType1, personType2;
-	std::string dummy = "0";
-
-	Random random;
+	Random random(seed);
 
 	while(!fit_pop)
 	{
@@ -269,81 +306,78 @@ void Area<GenericParams>::drawHouseholds(IPUWrapper<GenericParams> *ipuWrap, T *
 	
 		std::cout << "Drawing households - Attempt: " << ++num_draws << std::endl;
 
-		for(auto hh = prHouseholds->begin(); hh != prHouseholds->end(); ++hh)
+		//households are drawn into lists first when drawing in parallel or when the draw may be repaired
+		if(num_threads > 1 || repair)
 		{
-			//Household by type, size and income (type: Family houshold, single household etc)
-			hhType = hh->first;
-			num_households = ipuWrap->getHouseholdCount(hhType);
+			std::vector<HouseholdList> draws(aliasHouseholds->size());
+			std::vector<int> personCounts(num_threads, 0);
+
+			runBlocks<Counter<GenericParams>>(num_threads, &random, model->getCounter(), 
+				[&](int t, unsigned int workerSeed, Counter<GenericParams> *shard) {
+					drawHouseholdTypes(ipuWrap, t, num_threads, workerSeed, shard, &draws, &personCounts[t]);
+				});
+
+			for(int t = 0; t < num_threads; ++t)
+				countPer += personCounts[t];
 
-			while(num_households != 0)
+			for(size_t type = 0; type < draws.size(); ++type)
+				countHH += draws[type].size();
+
+			std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+
+			fit_pop = checkFit(ipuCons, model->getCounter(), num_draws, false);
+			if(!fit_pop && repair)
+			{
+				repairFit(ipuWrap, &draws, model->getCounter(), &random);
+				fit_pop = checkFit(ipuCons, model->getCounter(), num_draws, false);
+			}
+
+			if(fit_pop)
+				addDrawnHouseholds(ipuWrap, draws, model);
+		}
+		else
+		{
+			for(auto hh = aliasHouseholds->begin(); hh != aliasHouseholds->end(); ++hh)
 			{
-				randomP = random.uniform_real_dist();
-				for(auto hash = hh->second.begin(); hash != hh->second.end(); ++hash)
+				//Household by type, size and income (type: Family houshold, single household etc)
+				hhType = hh->first;
+				num_households = ipuWrap->getHouseholdCount(hhType);
+				int hhCode = model->getCounter()->getHouseholdTypeCode(hhType);
+
+				while(num_households > 0)
 				{
-					PairDD last_elem = hash->second.back();
-					double maxProb = last_elem.first;
+					hhIdx = hh->second.draw(random.uniform_real_dist());
+
+					countHH++;
+					const HouseholdPums<GenericParams> *household = &m_householdsPums->at(hhIdx);
+					countPer += countHousehold(hhCode, household, model->getCounter());
+
+					if(parameters->getSimType() == MASS_VIOLENCE || parameters->getSimType() == POP_MENTAL_HEALTH)
+						model->addHousehold(household, countHH);
+
+					if(parameters->getSimType() == EQUITY_EFFICIENCY)
+					{
+						const std::vector<PersonPums<GenericParams>> &persons = household->getPersonList();
+						for(auto pp = persons.begin(); pp != persons.end(); ++pp)
+							model->addAgent(&(*pp));
+					}
 
-					if(randomP < maxProb)
+					timer.stop();
+					if(timer.elapsed_ms() > waitTime)
 					{
-						for(auto pr = hash->second.begin(); pr != hash->second.end(); ++pr)
-						{
-							hhProb = pr->first;
-							hhIdx = pr->second;
-						
-							if(randomP < hhProb)
-							{
-								countHH++;
-								model->getCounter()->addHouseholdCount(hhType);
-
-								const HouseholdPums<GenericParams> *hh = &m_householdsPums->at(hhIdx);
-
-								if(parameters->getSimType() == MASS_VIOLENCE || parameters->getSimType() == POP_MENTAL_HEALTH)
-									model->addHousehold(hh, countHH);
-
-								tempPersons = hh->getPersons();
-								for(auto pp = tempPersons.begin(); pp != tempPersons.end(); ++pp)
-								{
-									sex = std::to_string(pp->getSex());
-									origin = std::to_string(pp->getOrigin());
-									ageCat = std::to_string(pp->getAgeCat());
-
-									personType1 = dummy+sex+ageCat+origin;
-									model->getCounter()->addPersonCount(personType1);
-			
-									if(pp->getAge() >= 18) 
-									{
-										eduAgeCat = std::to_string(pp->getEduAgeCat());
-										edu = std::to_string(pp->getEducation());
-
-										personType2 = sex+eduAgeCat+origin+edu;
-										model->getCounter()->addPersonCount(personType2);
-									}
-
-									countPer++;
-									if(parameters->getSimType() == EQUITY_EFFICIENCY)
-										model->addAgent(&(*pp));
-								}
-
-								timer.stop();
-								if(timer.elapsed_ms() > waitTime)
-								{
-									std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
-									timer.start();
-								}
-
-								num_households--;
-								break;
-							}
-						}
-						break;
+						std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+						timer.start();
 					}
+
+					num_households--;
 				}
 			}
-		}
 
-		std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+			std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+
+			fit_pop = checkFit(ipuCons, model->getCounter(), num_draws, false);
+		}
 
-		fit_pop = checkFit(ipuCons, model->getCounter(), num_draws);
 		if(!fit_pop)
 			model->clearList();
 	}
@@ -352,19 +386,334 @@ void Area<GenericParams>::drawHouseholds(IPUWrapper<GenericParams> *ipuWrap, T *
 }
 
 /*
-* @brief Chi-Square test to check the fit of the population
-* @param cons Household and person-level constraints from ACS
-* @param count Counter object of a given simulation model
-* @param num_draws Counter for number of times the households are drawn
-* @return Return true if fit is obtained
+* @brief Block of parallel household drawing (see runBlocks): draws households of every 
+*        num_threads-th household type.
+* @param ipuWrap IPUWrapper object
+* @param worker Index of worker thread
+* @param num_threads Number of worker threads
+* @param seed Seed of worker's random stream
+* @param count Thread-local counter
+* @param draws Drawn households (SERIALNO) by household type index
+* @param countPer Number of persons drawn by worker
 */
 template<class GenericParams>
-template<class T>
-bool Area<GenericParams>::checkFit(const Marginal *cons, const T *count, int num_draws)
+void Area<GenericParams>::drawHouseholdTypes(IPUWrapper<GenericParams> *ipuWrap, int worker, int num_threads, 
+	unsigned int seed, Counter<GenericParams> *count, std::vector<HouseholdList> *draws, int *countPer)
 {
+	const AliasMap *aliasHouseholds = ipuWrap->getHouseholdAliasTables();
+	const PUMSHouseholdsMap* m_householdsPums = ipuWrap->getHouseholds();
+
+	Random random(seed);
+
+	int type = 0;
+	for(auto hh = aliasHouseholds->begin(); hh != aliasHouseholds->end(); ++hh, ++type)
+	{
+		if(type % num_threads != worker)
+			continue;
+
+		double num_households = ipuWrap->getHouseholdCount(hh->first);
+		int hhCode = count->getHouseholdTypeCode(hh->first);
+		HouseholdList *hhList = &draws->at(type);
+		hhList->reserve((size_t)std::max(0.0, num_households));
+
+		while(num_households > 0)
+		{
+			double hhIdx = hh->second.draw(random.uniform_real_dist());
+			hhList->push_back(hhIdx);
+
+			*countPer += countHousehold(hhCode, &m_householdsPums->at(hhIdx), count);
+			num_households--;
+		}
+	}
+}
+
+/*
+* @brief Adds a drawn household and its persons (precomputed person type codes, see 
+*        HouseholdPums::setPersonTypes) to the counter
+* @param hhCode Code of household type in counter (-1 if household type is not counted)
+* @return Number of persons in household
+*/
+template<class GenericParams>
+int Area<GenericParams>::countHousehold(int hhCode, const HouseholdPums<GenericParams> *household, 
+	Counter<GenericParams> *count) const
+{
+	if(hhCode >= 0)
+		count->addHouseholdTypeCount(hhCode);
+
+	const std::vector<int> &personTypes = household->getPersonTypes();
+	for(size_t i = 0; i < personTypes.size(); ++i)
+		count->addPersonTypeCount(personTypes[i]);
+
+	return household->getPersonList().size();
+}
+
+/*
+* @brief Creates households by replicating each PUMS household by its integerized IPU weight 
+*        (see IPU::integerizeWeights). The result is deterministic and matches household counts
+*        exactly, so it is created once without fit retries. Fit is still tested and logged.
+* @param ipuWrap IPUWrapper object
+* @param model Model for which population is created
+*/
+template<class GenericParams>
+template <class T>
+void Area<GenericParams>::replicateHouseholds(IPUWrapper<GenericParams> *ipuWrap, T *model)
+{
+	std::cout << "Creating Households (integerized weights)...\n" << std::endl;
+
+	const AliasMap *aliasHouseholds = ipuWrap->getHouseholdAliasTables();
+	const ReplicationMap *hhReplications = ipuWrap->getHouseholdReplications();
+	const PUMSHouseholdsMap* m_householdsPums = ipuWrap->getHouseholds();
+	const Marginal *ipuCons = ipuWrap->getConstraints();
+
+	model->setSize(ipuWrap->getPopSize());
+	model->getCounter()->initialize();
+
+	std::vector<HouseholdList> draws(aliasHouseholds->size());
+	int countHH = 0; int countPer = 0;
+
+	int type = 0;
+	for(auto hh = aliasHouseholds->begin(); hh != aliasHouseholds->end(); ++hh, ++type)
+	{
+		auto reps = hhReplications->find(hh->first);
+		if(reps == hhReplications->end())
+			continue;
+
+		int hhCode = model->getCounter()->getHouseholdTypeCode(hh->first);
+
+		for(auto rep = reps->second.begin(); rep != reps->second.end(); ++rep)
+		{
+			const HouseholdPums<GenericParams> *household = &m_householdsPums->at(rep->first);
+			for(int copy = 0; copy < rep->second; ++copy)
+			{
+				draws[type].push_back(rep->first);
+				countPer += countHousehold(hhCode, household, model->getCounter());
+				countHH++;
+			}
+		}
+	}
+
+	std::cout << "Households Count:" << countHH << " Person Count: " <<  countPer << std::endl;
+
+	//single deterministic draw - fit is logged and accepted regardless of its p-value
+	checkFit(ipuCons, model->getCounter(), 1, true);
+	addDrawnHouseholds(ipuWrap, draws, model);
+
+	std::cout << "Households successfully created!\n" << std::endl;
+}
+
+/*
+* @brief Adds drawn households (and their persons) to the model in household type order
+* @param ipuWrap IPUWrapper object
+* @param draws Drawn households (SERIALNO) by household type index
+* @param model Model for which population is created
+*/
+template<class GenericParams>
+template <class T>
+void Area<GenericParams>::addDrawnHouseholds(IPUWrapper<GenericParams> *ipuWrap, const std::vector<HouseholdList> &draws, T *model)
+{
+	const PUMSHouseholdsMap* m_householdsPums = ipuWrap->getHouseholds();
+
+	int countHH = 0;
+	for(size_t type = 0; type < draws.size(); ++type)
+	{
+		for(size_t h = 0; h < draws[type].size(); ++h)
+		{
+			countHH++;
+			const HouseholdPums<GenericParams> *household = &m_householdsPums->at(draws[type][h]);
+
+			if(parameters->getSimType() == MASS_VIOLENCE || parameters->getSimType() == POP_MENTAL_HEALTH)
+				model->addHousehold(household, countHH);
+
+			if(parameters->getSimType() == EQUITY_EFFICIENCY)
+			{
+				const std::vector<PersonPums<GenericParams>> &persons = household->getPersonList();
+				for(auto pp = persons.begin(); pp != persons.end(); ++pp)
+					model->addAgent(&(*pp));
+			}
+		}
+	}
+}
+
+/*
+* @brief Repairs a poorly fitting draw instead of redrawing the whole population. Repeatedly 
+*        picks the person cell with largest standardized deviation, and swaps a drawn household 
+*        (containing that cell if it is over-represented) with a household of the same type, 
+*        drawn by its IPU probability, if the swap reduces the chi-square statistic. Stops 
+*        when the p-value exceeds alpha or the swap budget (number of drawn households) is used.
+* @param ipuWrap IPUWrapper object
+* @param draws Drawn households (SERIALNO) by household type index
+* @param count Counter of drawn households and persons
+* @param random Random number generator
+*/
+template<class GenericParams>
+void Area<GenericParams>::repairFit(IPUWrapper<GenericParams> *ipuWrap, std::vector<HouseholdList> *draws, 
+	Counter<GenericParams> *count, Random *random)
+{
+	const AliasMap *aliasHouseholds = ipuWrap->getHouseholdAliasTables();
+	const PUMSHouseholdsMap* m_householdsPums = ipuWrap->getHouseholds();
+	const Marginal *cons = ipuWrap->getConstraints();
+
+	//person cells used in chi-square test
+	Pool fit_pool = getFitPersonPool();
+	int num_hh_type = (ACS::HHType::_size()*ACS::HHSize::_size()*ACS::HHIncome::_size())+1;
+
+	//cell index by person type code (person pool index), -1 if person type isn't a cell
+	std::vector<int> cellIdx(parameters->getPersonPool()->size(), -1);
 	std::vector<double> obsFreq, estFreq;
-	bool fit = false;
+	double sum_chi_sqr = 0;
+	for(size_t i = 0; i < fit_pool.size(); ++i)
+	{
+		double est = cons->at(num_hh_type+i);
+		if(est >= parameters->getMinSampleSize())
+		{
+			int code = count->getPersonTypeCode(fit_pool[i]);
+			if(code >= 0 && code < (int)cellIdx.size())
+				cellIdx[code] = estFreq.size();
+			estFreq.push_back(est);
+			obsFreq.push_back(count->getPersonCount(fit_pool[i]));
+			sum_chi_sqr += (obsFreq.back()-est)*(obsFreq.back()-est)/est;
+		}
+	}
+
+	if(estFreq.size() < 2)
+		return;
+
+	std::vector<const AliasTable *> tables;
+	for(auto hh = aliasHouseholds->begin(); hh != aliasHouseholds->end(); ++hh)
+		tables.push_back(&hh->second);
+
+	std::vector<std::pair<int, int>> drawnHH;
+	for(size_t type = 0; type < draws->size(); ++type)
+		for(size_t h = 0; h < draws->at(type).size(); ++h)
+			drawnHH.push_back(std::make_pair(type, h));
+
+	if(drawnHH.empty())
+		return;
+
+	boost::math::chi_squared dist(estFreq.size()-1);
+	double p_val = 1-(boost::math::cdf(dist, sum_chi_sqr));
+
+	const int max_candidates = 10;
+	int max_swaps = drawnHH.size();
+	int swaps = 0;
+
+	std::cout << "Repairing draw..." << std::endl;
+
+	for(int tries = 0; tries < max_swaps && p_val <= parameters->getAlpha(); ++tries)
+	{
+		//worst fitting cell
+		int worst = 0;
+		double max_dev = 0;
+		for(size_t k = 0; k < estFreq.size(); ++k)
+		{
+			double dev = fabs(obsFreq[k]-estFreq[k])/sqrt(estFreq[k]);
+			if(dev > max_dev)
+			{
+				max_dev = dev;
+				worst = k;
+			}
+		}
+		bool over = (obsFreq[worst] > estFreq[worst]);
+
+		//household to swap out (must contain worst cell if it is over-represented)
+		std::pair<int, int> out;
+		std::map<int, int> outCells;
+		bool found = false;
+		for(int c = 0; c < max_candidates && !found; ++c)
+		{
+			out = drawnHH[random->random_int(0, drawnHH.size()-1)];
+			const std::vector<int> &outTypes = m_householdsPums->at(draws->at(out.first)[out.second]).getPersonTypes();
+
+			outCells.clear();
+			for(size_t i = 0; i < outTypes.size(); ++i)
+				if(cellIdx[outTypes[i]] >= 0)
+					outCells[cellIdx[outTypes[i]]]--;
+
+			found = (!over || outCells.count(worst) > 0);
+		}
+
+		if(!found)
+			continue;
+
+		//best replacement of the same household type
+		double best_change = 0;
+		double best_hhIdx = -1;
+		std::map<int, int> bestCells;
+		for(int c = 0; c < max_candidates; ++c)
+		{
+			double hhIdx = tables[out.first]->draw(random->uniform_real_dist());
+			const std::vector<int> &inTypes = m_householdsPums->at(hhIdx).getPersonTypes();
+
+			std::map<int, int> cells(outCells);
+			for(size_t i = 0; i < inTypes.size(); ++i)
+				if(cellIdx[inTypes[i]] >= 0)
+					cells[cellIdx[inTypes[i]]]++;
+
+			double change = getChiSquareChange(cells, obsFreq, estFreq);
+			if(change < best_change)
+			{
+				best_change = change;
+				best_hhIdx = hhIdx;
+				bestCells = cells;
+			}
+		}
+
+		if(best_hhIdx < 0)
+			continue;
+
+		//swap households
+		double &outIdx = draws->at(out.first)[out.second];
+
+		const std::vector<int> &outTypes = m_householdsPums->at(outIdx).getPersonTypes();
+		for(size_t i = 0; i < outTypes.size(); ++i)
+			count->removePersonTypeCount(outTypes[i]);
+
+		const std::vector<int> &inTypes = m_householdsPums->at(best_hhIdx).getPersonTypes();
+		for(size_t i = 0; i < inTypes.size(); ++i)
+			count->addPersonTypeCount(inTypes[i]);
 
+		for(auto cell = bestCells.begin(); cell != bestCells.end(); ++cell)
+			obsFreq[cell->first] += cell->second;
+
+		outIdx = best_hhIdx;
+		sum_chi_sqr += best_change;
+		p_val = 1-(boost::math::cdf(dist, std::max(0.0, sum_chi_sqr)));
+		swaps++;
+	}
+
+	std::cout << "Households swapped: " << swaps << std::endl;
+}
+
+/*
+* @brief Returns change of chi-square statistic when person counts of cells change
+* @param cells Change of person count by cell index
+* @param obsFreq Observed person count by cell index
+* @param estFreq Estimated person count by cell index
+*/
+template<class GenericParams>
+double Area<GenericParams>::getChiSquareChange(const std::map<int, int> &cells, const std::vector<double> &obsFreq, 
+	const std::vector<double> &estFreq) const
+{
+	double change = 0;
+	for(auto cell = cells.begin(); cell != cells.end(); ++cell)
+	{
+		int k = cell->first;
+		double diff_old = obsFreq[k]-estFreq[k];
+		double diff_new = diff_old+cell->second;
+
+		change += (diff_new*diff_new-diff_old*diff_old)/estFreq[k];
+	}
+
+	return change;
+}
+
+/*
+* @brief Returns person types compared with person-level constraints in the chi-square test
+*        (children by sex, age and origin and adults by sex, age, origin and education)
+*/
+template<class GenericParams>
+typename Area<GenericParams>::Pool Area<GenericParams>::getFitPersonPool() const
+{
 	//Get pool of person types
 	Pool temp_person_pool = *(parameters->getPersonPool());
 
@@ -380,6 +729,26 @@ bool Area<GenericParams>::checkFit(const Marginal *cons, const T *count, int num
 	//erase female adults from individual pool
 	temp_person_pool.erase(temp_person_pool.begin()+female_child_start, temp_person_pool.begin()+female_child_end);
 
+	return temp_person_pool;
+}
+
+/*
+* @brief Chi-Square test to check the fit of the population
+* @param cons Household and person-level constraints from ACS
+* @param count Counter object of a given simulation model
+* @param num_draws Counter for number of times the households are drawn
+* @param forceAccept Accepts the fit regardless of p-value (e.g. a deterministic draw)
+* @return Return true if fit is obtained
+*/
+template<class GenericParams>
+template<class T>
+bool Area<GenericParams>::checkFit(const Marginal *cons, const T *count, int num_draws, bool forceAccept)
+{
+	std::vector<double> obsFreq, estFreq;
+	bool fit = false;
+
+	Pool temp_person_pool = getFitPersonPool();
+
 	//Artificially generated person count (obtained from drawing households)
 	for(size_t i = 0; i < temp_person_pool.size(); ++i)
 		obsFreq.push_back(count->getPersonCount(temp_person_pool[i]));
@@ -423,7 +792,7 @@ bool Area<GenericParams>::checkFit(const Marginal *cons, const T *count, int num
 	
 	//bool fit = (p_val < alpha) ? false : true;
 
-	if(p_val > parameters->getAlpha())
+	if(p_val > parameters->getAlpha() || forceAccept)
 		fit = true;
 	else if(num_draws == parameters->getMaxDraws())
 		fit = true;
@@ -440,6 +809,8 @@ bool Area<GenericParams>::checkFit(const Marginal *cons, const T *count, int num
 template<class GenericParams>
 void Area<GenericParams>::gofLog(double pval, int df, int num_draws)
 {
+	std::lock_guard<std::mutex> lock(gofLogMutex);
+
 	std::ofstream logFile;
 	logFile.open(parameters->getOutputDir() + "gofLog.txt", std::ios::app);
 
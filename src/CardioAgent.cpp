@@ -5,6 +5,9 @@
 //#include "Parameters.h"
 #include "CardioCounter.h"
 
+#include <limits>
+#include <algorithm>
+
 CardioAgent::CardioAgent()
 {
 }
@@ -37,17 +40,22 @@ CardioAgent::CardioAgent(const PersonPums<CardioParams> *person, std::shared_ptr
 
 	this->rfStrata = -1;
 
-	this->pTotalCHD = 0;
-	this->pFatalCHD = 0;
+	this->pTotalCHD = this->initPTotalCHD = 0;
+	this->pFatalCHD = this->initPFatalCHD = 0;
 
 	this->dead = false;
+	this->riskChanged = false;
 	this->deathYear = -1;
 
+	this->commonRandom = parameters->commonRandomNumbers();
+	this->randomKey = commonRandom ? (unsigned int)random->random_int(1, std::numeric_limits<int>::max()) : 0;
+	resetRandomStreams();
+
 	setNHANESAgeCat();
 
-	counter->addPersonCount(nhanes_org, sex);
+	counter->addRaceGenderCount(nhanes_org, sex);
 	//count agent by race, gender and education - used to calculate education difference
-	counter->addPersonCount(getAgentType4()); 
+	counter->addRaceGenderEduCount(nhanes_org, sex, nhanes_edu); 
 
 }
 
@@ -100,7 +108,23 @@ void CardioAgent::setRiskFactors(short int risk_strata, EET::RiskFactors risk_fa
 	this->initRiskStrata = this->rfStrata = risk_strata;
 	this->initChart = this->chart = risk_factors;
 
-	counter->addRiskFactors(this, getAgentType2(), getAgentType4());
+	counter->addRiskFactors(this);
+}
+
+/*
+* @brief Sets counter the agent reports to (e.g. thread-local counter in parallel loops)
+*/
+void CardioAgent::setCounter(CardioCounter *count)
+{
+	this->counter = count;
+}
+
+/*
+* @brief Sets random number generator used by the agent (e.g. per-thread stream in parallel loops)
+*/
+void CardioAgent::setRandom(Random *rand)
+{
+	this->random = rand;
 }
 
 void CardioAgent::update(int intervention_type, int taxType, int statinsType, int currentYear, bool isEducationPresent)
@@ -109,67 +133,72 @@ void CardioAgent::update(int intervention_type, int taxType, int statinsType, in
 	updateRiskFactors(intervention_type, taxType, statinsType, currentYear, isEducationPresent);
 }
 
-void CardioAgent::computeTenYearCHDRisk(std::string timeFrame)
+/*
+* @brief Sets 10-year total (Framingham) and fatal (SCORE) CHD risk computed by CardioPopulation.
+*        Risk before the intervention is kept as the initial risk restored by resetAttributes.
+*        After the intervention, year of fatal CHD is drawn from the fatal CHD risk.
+* @param timeFrame Before or after intervention time period
+* @param pTotal 10-year risk of total CHD
+* @param pFatal 10-year risk of fatal CHD
+*/
+void CardioAgent::setTenYearCHDRisk(std::string timeFrame, double pTotal, double pFatal)
 {
-	computeFraminghamCHDRisk(timeFrame);
-	computeScoreFatalCHDRisk(timeFrame);
+	this->pTotalCHD = pTotal;
+	this->pFatalCHD = pFatal;
+
+	if(timeFrame == parameters->beforeIntervention())
+	{
+		this->initPTotalCHD = pTotal;
+		this->initPFatalCHD = pFatal;
+	}
+	else if(timeFrame == parameters->afterIntervention())
+	{
+		double randomP = drawUniform(death_stream);
+		if(randomP < pFatalCHD)
+		{
+			this->deathYear = drawInt(death_stream, 1, num_years);
+		}
+	}
+
+	int typeCode = CardioCounter::getTypeCode(nhanes_org, sex);
+	counter->addTenYearTotalCHDRisk(timeFrame, typeCode, this->pTotalCHD);
+	counter->addTenYearFatalCHDRisk(timeFrame, typeCode, this->pFatalCHD);
+
 	computeRiskFactorDifference(timeFrame);
 }
 
-void CardioAgent::processChdEvent(int id, int statinsType, int taxType, int year, bool isEducationPresent)
+/*
+* @brief Processes fatal CHD event of the agent over the 10-year period. Year of death is drawn
+*        with the 10-year risk after the intervention (see setTenYearCHDRisk).
+* @param interventionType Intervention type (see CardioParams::getInterventionType)
+* @param numYears Number of years processed
+* @return Year of death, or 0 if the agent survives the period
+*/
+int CardioAgent::processChdEvent(std::string interventionType, int numYears)
 {
-	deathFatalChd(parameters->getInterventionType(id, statinsType, taxType, isEducationPresent), year);
-	//updateAge();
-
-	if(!isDead())
+	if(deathYear >= 1 && deathYear <= numYears)
 	{
-		counter->addStatinsUsage(this, getAgentType2(), parameters->afterIntervention(year+1), id, statinsType, taxType, isEducationPresent);	
+		deathFatalChd(interventionType, deathYear);
+		return deathYear;
 	}
+	else
+		return 0;
 }
 
 void CardioAgent::resetAttributes()
 {
 	this->dead = false;
+	this->riskChanged = false;
 	this->deathYear = -1;
 
+	this->pTotalCHD = this->initPTotalCHD;
+	this->pFatalCHD = this->initPFatalCHD;
+
+	resetRandomStreams();
 	resetAge();
 	resetRiskFactors();
 }
 
-void CardioAgent::computeFraminghamCHDRisk(std::string timeFrame)
-{
-	MapDbl weighted_sum;
-	for(auto type : NHANES::WeightedSum::_values())
-		weighted_sum.insert(std::make_pair(type, getWeightedSumFramingham(type)));
-
-	double e = exp(weighted_sum[NHANES::WeightedSum::Individual] - weighted_sum[NHANES::WeightedSum::Mean]);
-
-	double survival_rate = getTenYrTotalCHDSurvivalARIC();
-	this->pTotalCHD = 1 - pow(survival_rate, e);
-
-	counter->addTenYearTotalCHDRisk(timeFrame, getAgentType2(), getAgentType(), this->pTotalCHD);
-}
-
-void CardioAgent::computeScoreFatalCHDRisk(std::string timeFrame)
-{
-	double e = exp(getWeightedSumScore());
-	double fatal_survival_rate = getTenYrFatalCHDSurvivalARIC();
-
-	this->pFatalCHD = 1 - pow(fatal_survival_rate, e);
-
-	if(timeFrame == parameters->afterIntervention())
-	{
-		double randomP = random->uniform_real_dist();
-		if(randomP < pFatalCHD)
-		{
-			this->deathYear = random->random_int(1, num_years);
-		}
-	}
-
-	counter->addTenYearFatalCHDRisk(timeFrame, getAgentType2(), getAgentType(), this->pFatalCHD);
-	
-}
-
 void CardioAgent::computeRiskFactorDifference(std::string timeFrame)
 {
 	std::string agentType = getAgentType2();
@@ -249,6 +278,8 @@ void CardioAgent::updateAge()
 
 void CardioAgent::updateRiskFactors(int interventionId, int taxType, int statinsType, int currentYear, bool isEducationPresent)
 {
+	EET::RiskFactors prevChart = chart;
+
 	switch(interventionId)
 	{
 	case EET::EduIntervention::Education:
@@ -268,8 +299,11 @@ void CardioAgent::updateRiskFactors(int interventionId, int taxType, int statins
 		break;
 	}
 
+	if(isCHDRiskInputChanged(prevChart))
+		this->riskChanged = true;
+
 	//counter->addRiskFactors(this, getAgentType2());
-	counter->addRiskFactors(this, getAgentType2(), getAgentType4());
+	counter->addRiskFactors(this);
 }
 
 void CardioAgent::resetAge()
@@ -332,7 +366,7 @@ void CardioAgent::setRiskStrata(short int rs)
 */
 void CardioAgent::smokingTaxIntervention(bool isEducationPresent, int tax_type, int currentYear)
 {
-	double randP = random->uniform_real_dist();
+	double randP = drawUniform(tax_stream);
 	double pChangeSmoking = getPercentChangeSmoking(tax_type);
 
 	if(chart.isSmoker && pChangeSmoking < 0)
@@ -401,84 +435,67 @@ void CardioAgent::educationIntervention()
 		}
 	}
 	counter->addStatinsUsage(this, getAgentType2(), parameters->afterIntervention(), EET::EduIntervention::Education, 0, 0, true);
-	counter->addPersonCount(getAgentType4());
+	counter->addRaceGenderEduCount(nhanes_org, sex, nhanes_edu);
 	
 }
 
 /*
 * @brief Updates the risk factors of agents for smoking tax intervention. 
-*        Gets the list of new risk factors after the change in smoking status
-*        and risk strata. Randomly select from the list of risk factors until
-*		 new risk factor is less than old risk factor (if smoking status is changed
-*        from smoker to non-smoker (or former smoker).
+*        Gets the candidate risk factors after the change in smoking status
+*        and risk strata (see CardioParams::getReplacementRisks). A new smoker draws
+*        from candidates with greater risk than the old risk factor, an agent who quit 
+*        smoking draws from former smokers with lower (or equal) risk. Candidates are sorted 
+*        by sum of risks, so each draw is a single random index into a range of a list.
 */
 void CardioAgent::updateRisksTaxIntervention(int tax_type)
 {
-	//const VectorWeightRisks *new_risks = parameters->getRiskFactorByStrata(getAgentType1(), rfStrata);
-	const VectorWeightRisks *new_risks = parameters->getRiskFactorByStrata(getAgentType5(), rfStrata);
-	int count = 0;
+	const EET::ReplacementRisks *new_risks = parameters->getReplacementRisks(nhanes_org, sex, nhanes_ageCat, nhanes_edu, rfStrata);
+	const EET::SortedRisks &all = new_risks->all;
 
 	bool wasOnStatins = isOnStatin();
 
 	EET::RiskFactors oldRiskFactor = this->chart;
 
-	while(true)
+	if(all.risks.size() > 0)
 	{
-		if(new_risks->size() == 0)
-			break;
+		double sumRisks = getSumRisks(chart);
 
-		int idx = random->random_int(0, new_risks->size()-1);
-
-		EET::RiskFactors newRiskFactor = new_risks->at(idx).second;
+		//candidates with greater risk are the suffix of the list
+		int firstGreater = std::upper_bound(all.sumRisks.begin(), all.sumRisks.end(), sumRisks) - all.sumRisks.begin();
+		int numGreater = (int)all.risks.size() - firstGreater;
 
 		if(chart.isSmoker)
 		{
-			if(isNewRiskGreater(newRiskFactor))
-			{
-				this->chart = newRiskFactor;
-				break;
-			}
+			if(numGreater > 0)
+				this->chart = all.risks[firstGreater + drawInt(tax_stream, 0, numGreater-1)];
 			else
-			{
-				if(count == new_risks->size())
-				{
-					this->chart = newRiskFactor;
-					break;
-				}
-
-				count++;
-				continue;
-			}
+				this->chart = all.risks[drawInt(tax_stream, 0, all.risks.size()-1)];
 		}
-		else if(!chart.isSmoker)
-		{ 
-			if (!isNewRiskGreater(newRiskFactor)) 
-			{
-				if (newRiskFactor.curSmokeStat == NHANES::SmokingStatus::FormerSmoker)
-				{
-					this->chart = newRiskFactor;
-					break;
-				}
-				else if(newRiskFactor.curSmokeStat == NHANES::SmokingStatus::NonSmoker)
-				{
-					if (count == new_risks->size())
-					{
-						this->chart = newRiskFactor;
-						break;
-					}
-				}
+		else
+		{
+			const EET::SortedRisks &former = new_risks->formerSmoker;
+			const EET::SortedRisks &nonSmoker = new_risks->nonSmoker;
 
+			//candidates with lower (or equal) risk are the prefix of the list
+			int numFormer = std::upper_bound(former.sumRisks.begin(), former.sumRisks.end(), sumRisks) - former.sumRisks.begin();
+			int numNonSmoker = std::upper_bound(nonSmoker.sumRisks.begin(), nonSmoker.sumRisks.end(), sumRisks) - nonSmoker.sumRisks.begin();
+
+			if(numFormer > 0)
+			{
+				this->chart = former.risks[drawInt(tax_stream, 0, numFormer-1)];
 			}
 			else
 			{
-				if (count > new_risks->size()) 
-				{
-					this->chart = newRiskFactor;
-					break;
-				}
+				//without former smokers of lower risk, a non-smoker of lower risk is chosen with
+				//its share of all candidates, otherwise a candidate with greater risk
+				int idx = drawInt(tax_stream, 0, all.risks.size()-1);
+				if(idx < numNonSmoker)
+					this->chart = nonSmoker.risks[idx];
+				else if(numGreater > 0)
+					this->chart = all.risks[firstGreater + drawInt(tax_stream, 0, numGreater-1)];
+				else
+					this->chart = all.risks[idx];
 			}
-			
-			count++;
 		}
 	}
 
@@ -575,7 +592,7 @@ void CardioAgent::updateRisksStatinsIntervention(int id, int statinsType, int ta
 		statinUptake = (statinUptake) / (1-statinUptake);
 	}
 
-	double randP = random->uniform_real_dist();
+	double randP = drawUniform(statin_stream);
 	if(randP < statinUptake)
 	{
 		chart.onStatin = 1;
@@ -617,6 +634,40 @@ void CardioAgent::updateRisksEducationIntervention(double randP)
 	}
 }
 
+/*
+* @brief Restarts random streams of the agent, so that every intervention scenario
+*        replays the same random numbers (common random numbers)
+*/
+void CardioAgent::resetRandomStreams()
+{
+	for(int i = 0; i < num_streams; ++i)
+		streams[i].seed(randomKey, i);
+}
+
+/*
+* @brief Returns uniform random number from the stream of the given purpose if common 
+*        random numbers are used, otherwise from the random stream of the model
+* @param stream Purpose of the draw (tax_stream, statin_stream or death_stream)
+*/
+double CardioAgent::drawUniform(int stream)
+{
+	if(commonRandom)
+		return streams[stream].uniform_real_dist();
+	else
+		return random->uniform_real_dist();
+}
+
+/*
+* @brief Returns random integer in [min, max] (see drawUniform)
+*/
+int CardioAgent::drawInt(int stream, int min, int max)
+{
+	if(commonRandom)
+		return streams[stream].random_int(min, max);
+	else
+		return random->random_int(min, max);
+}
+
 void CardioAgent::deathFatalChd(std::string interventionType, int year)
 {
 	//double randomP = random->uniform_real_dist();
@@ -642,6 +693,23 @@ bool CardioAgent::isNewRiskGreater(EET::RiskFactors new_risks)
 		return false;
 }
 
+/*
+* @brief Returns true if current chart differs from the given chart in any input of 
+*        Framingham or SCORE equations
+* @param prevChart Chart to compare with
+*/
+bool CardioAgent::isCHDRiskInputChanged(const EET::RiskFactors &prevChart) const
+{
+	if(chart.tchols.first != prevChart.tchols.first || chart.hdlChols.first != prevChart.hdlChols.first)
+		return true;
+	else if(chart.systolicBp.first != prevChart.systolicBp.first)
+		return true;
+	else if(chart.htnMed != prevChart.htnMed || chart.curSmokeStat != prevChart.curSmokeStat)
+		return true;
+	else
+		return false;
+}
+
 bool CardioAgent::isStatinQualified() const
 {
 	bool isAtRisk = false;
@@ -672,117 +740,12 @@ bool CardioAgent::isStatinQualified() const
 }
 
 
-double CardioAgent::getWeightedSumFramingham(int type)
-{
-	double sum = 0;
-	short int age_ = this->initAge;
-
-	EET::Framingham b = getBetaFHS();
-	switch(type)
-	{
-	case NHANES::WeightedSum::Individual:
-		{
-			if(sex == NHANES::Sex::Male && age_ > 70)
-				age_ = 70;
-			else if(sex == NHANES::Sex::Female && age_ > 78)
-				age_ = 78;
-
-			sum = b.age*log(age_) + b.tchols*log(chart.tchols.first) + b.hdl*log(chart.hdlChols.first) 
-				+ b.sbp*log(chart.systolicBp.first) + b.htn*chart.htnMed + b.smoker*chart.curSmokeStat
-				+ b.age_tchols*log(age_)*log(chart.tchols.first) + b.age_smoker*log(age_)*chart.curSmokeStat
-				+ b.sq_age*log(age_)*log(age_);
-			break;
-		}
-	case NHANES::WeightedSum::Mean:
-		{
-			double meanAge = getMeanAge(parameters->beforeIntervention());
-			double meanTchols = getMeanTChols(parameters->beforeIntervention());
-			double meanHDL = getMeanHDL(parameters->beforeIntervention());
-			double meanSBP = getMeanSysBp(parameters->beforeIntervention());
-			double percentHTN = getPercentHTN(parameters->beforeIntervention());
-			double percentSmoking = getPercentSmoking(parameters->beforeIntervention());
-
-			sum = b.age*log(meanAge) + b.tchols*log(meanTchols) + b.hdl*log(meanHDL) 
-				+ b.sbp*log(meanSBP) + b.htn*percentHTN + b.smoker*percentSmoking
-				+ b.age_tchols*log(meanAge)*log(meanTchols) + b.age_smoker*log(meanAge)*percentSmoking
-				+ b.sq_age*log(meanAge)*log(meanAge);
-			break;
-		}
-	default:
-		break;
-	}
-
-	return sum;
-}
-
-double CardioAgent::getWeightedSumScore()
-{
-	const double chols_conversion = 0.02586;
-	double sum = 0;
-
-	EET::Score beta = getBetaScore();
-	sum = beta.tchols*(chols_conversion*(chart.tchols.first-getMeanTChols(parameters->beforeIntervention()))) 
-		+ beta.sbp*(chart.systolicBp.first-getMeanSysBp(parameters->beforeIntervention())) 
-		+ beta.smoking*(chart.curSmokeStat);
-	return sum;
-}
-
 double CardioAgent::getSumRisks(EET::RiskFactors risk)
 {
 	return risk.tchols.first + risk.systolicBp.first;
 }
 
 
-EET::Framingham CardioAgent::getBetaFHS()
-{
-	if(sex == NHANES::Sex::Male)
-		return parameters->getCardioParam()->male_coeff;
-	else
-		return parameters->getCardioParam()->female_coeff;
-}
-
-EET::Score CardioAgent::getBetaScore()
-{
-	return parameters->getCardioParam()->score_beta_coeff;
-}
-
-double CardioAgent::getTenYrSurvivalFramingham()
-{
-	if(sex == NHANES::Sex::Male)
-		return parameters->getCardioParam()->chd_survival_male_fhs;
-	else
-		return parameters->getCardioParam()->chd_survival_female_fhs;
-}
-
-double CardioAgent::getTenYrTotalCHDSurvivalARIC()
-{
-	if(nhanes_org == NHANES::Org::WhiteNH && sex == NHANES::Sex::Male)
-		return parameters->getCardioParam()->chd_survival_white_male;
-	else if(nhanes_org == NHANES::Org::WhiteNH && sex == NHANES::Sex::Female)
-		return parameters->getCardioParam()->chd_survival_white_female;
-	else if(nhanes_org == NHANES::Org::BlackNH && sex == NHANES::Sex::Male)
-		return parameters->getCardioParam()->chd_survival_black_male;
-	else if(nhanes_org == NHANES::Org::BlackNH && sex == NHANES::Sex::Female)
-		return parameters->getCardioParam()->chd_survival_black_female;
-	else
-		return -1;
-	
-}
-
-double CardioAgent::getTenYrFatalCHDSurvivalARIC()
-{
-	if(nhanes_org == NHANES::Org::WhiteNH && sex == NHANES::Sex::Male)
-		return parameters->getCardioParam()->fatal_chd_survival_white_male;
-	else if(nhanes_org == NHANES::Org::WhiteNH && sex == NHANES::Sex::Female)
-		return parameters->getCardioParam()->fatal_chd_survival_white_female;
-	else if(nhanes_org == NHANES::Org::BlackNH && sex == NHANES::Sex::Male)
-		return parameters->getCardioParam()->fatal_chd_survival_black_male;
-	else if(nhanes_org == NHANES::Org::BlackNH && sex == NHANES::Sex::Female)
-		return parameters->getCardioParam()->fatal_chd_survival_black_female;
-	else
-		return -1;
-}
-
 double CardioAgent::getPercentChangeSmoking(int tax_type)
 {
 	if(nhanes_edu == NHANES::Edu::HS_or_less)
@@ -1096,29 +1059,50 @@ double CardioAgent::getRiskFactor(int risk) const
 }
 
 
+const EET::RiskFactors *CardioAgent::getRiskFactors() const
+{
+	return &chart;
+}
+
+/*
+* @brief Returns 10-year total CHD risk of the agent before intervention
+*/
+double CardioAgent::getBaselineTotalCHDRisk() const
+{
+	return this->initPTotalCHD;
+}
+
+/*
+* @brief Returns 10-year fatal CHD risk of the agent before intervention
+*/
+double CardioAgent::getBaselineFatalCHDRisk() const
+{
+	return this->initPFatalCHD;
+}
+
 double CardioAgent::getMeanAge(std::string timeFrame) const
 {
-	return (counter->getMeanRiskFactor(timeFrame, getAgentType2(), NHANES::RiskFac::Age));
+	return (counter->getMeanRiskFactor(timeFrame, CardioCounter::getTypeCode(nhanes_org, sex), NHANES::RiskFac::Age));
 }
 
 double CardioAgent::getMeanHDL(std::string timeFrame) const
 {
-	return (counter->getMeanRiskFactor(timeFrame, getAgentType2(), NHANES::RiskFac::HdlChols));
+	return (counter->getMeanRiskFactor(timeFrame, CardioCounter::getTypeCode(nhanes_org, sex), NHANES::RiskFac::HdlChols));
 }
 
 double CardioAgent::getMeanTChols(std::string timeFrame) const
 {
-	return (counter->getMeanRiskFactor(timeFrame, getAgentType2(), NHANES::RiskFac::totalChols));
+	return (counter->getMeanRiskFactor(timeFrame, CardioCounter::getTypeCode(nhanes_org, sex), NHANES::RiskFac::totalChols));
 }
 
 double CardioAgent::getMeanSysBp(std::string timeFrame) const
 {
-	return (counter->getMeanRiskFactor(timeFrame, getAgentType2(), NHANES::RiskFac::SystolicBp));
+	return (counter->getMeanRiskFactor(timeFrame, CardioCounter::getTypeCode(nhanes_org, sex), NHANES::RiskFac::SystolicBp));
 }
 
 double CardioAgent::getPercentSmoking(std::string timeFrame) const
 {
-	return counter->getMeanRiskFactor(timeFrame, getAgentType2(), NHANES::RiskFac::SmokingStat);
+	return counter->getMeanRiskFactor(timeFrame, CardioCounter::getTypeCode(nhanes_org, sex), NHANES::RiskFac::SmokingStat);
 }
 
 double CardioAgent::getPercentSmoking(bool isEducationPresent, int currentYear) const
@@ -1127,22 +1111,22 @@ double CardioAgent::getPercentSmoking(bool isEducationPresent, int currentYear)
 	{
 		if(currentYear == 0)
 		{
-			return counter->getMeanRiskFactor(parameters->beforeIntervention(), getAgentType4(), NHANES::RiskFac::SmokingStat);
+			return counter->getMeanRiskFactor(parameters->beforeIntervention(), CardioCounter::getTypeCode(nhanes_org, sex, nhanes_edu), NHANES::RiskFac::SmokingStat);
 		}
 		else
 		{
-			return counter->getMeanRiskFactor(parameters->afterIntervention(), getAgentType4(), NHANES::RiskFac::SmokingStat);
+			return counter->getMeanRiskFactor(parameters->afterIntervention(), CardioCounter::getTypeCode(nhanes_org, sex, nhanes_edu), NHANES::RiskFac::SmokingStat);
 		}
 	}
 	else
 	{
 		if(currentYear == 0)
 		{
-			return counter->getMeanRiskFactor(parameters->afterEducation(), getAgentType4(), NHANES::RiskFac::SmokingStat);
+			return counter->getMeanRiskFactor(parameters->afterEducation(), CardioCounter::getTypeCode(nhanes_org, sex, nhanes_edu), NHANES::RiskFac::SmokingStat);
 		}
 		else
 		{
-			return counter->getMeanRiskFactor(parameters->afterIntervention(), getAgentType4(), NHANES::RiskFac::SmokingStat);
+			return counter->getMeanRiskFactor(parameters->afterIntervention(), CardioCounter::getTypeCode(nhanes_org, sex, nhanes_edu), NHANES::RiskFac::SmokingStat);
 		}
 		
 	}
@@ -1150,7 +1134,7 @@ double CardioAgent::getPercentSmoking(bool isEducationPresent, int currentYear)
 
 double CardioAgent::getPercentHTN(std::string timeFrame) const
 {
-	return counter->getMeanRiskFactor(timeFrame, getAgentType2(), NHANES::RiskFac::HyperTension);
+	return counter->getMeanRiskFactor(timeFrame, CardioCounter::getTypeCode(nhanes_org, sex), NHANES::RiskFac::HyperTension);
 }
 
 
@@ -1159,6 +1143,11 @@ bool CardioAgent::isDead() const
 	return this->dead;
 }
 
+bool CardioAgent::isRiskChanged() const
+{
+	return this->riskChanged;
+}
+
 bool CardioAgent::isOnStatin() const
 {
 	if(chart.onStatin)
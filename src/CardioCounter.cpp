@@ -2,6 +2,37 @@
 #include "CardioAgent.h"
 #include "CardioParams.h"
 
+namespace
+{
+	//adds counts of a nested counter map into another counter map of same schema
+	void mergeCounts(double &dst, const double &src)
+	{
+		dst += src;
+	}
+
+	void mergeCounts(RunningStat &dst, const RunningStat &src)
+	{
+		dst.merge(src);
+	}
+
+	template<class Value>
+	void mergeCounts(std::vector<Value> &dst, const std::vector<Value> &src)
+	{
+		if(dst.size() < src.size())
+			dst.resize(src.size());
+
+		for(size_t i = 0; i < src.size(); ++i)
+			mergeCounts(dst[i], src[i]);
+	}
+
+	template<class Key, class Value>
+	void mergeCounts(std::map<Key, Value> &dst, const std::map<Key, Value> &src)
+	{
+		for(auto it = src.begin(); it != src.end(); ++it)
+			mergeCounts(dst[it->first], it->second);
+	}
+}
+
 
 CardioCounter::CardioCounter()
 {
@@ -22,6 +53,84 @@ void CardioCounter::initialize()
 	initRiskFacCounter();
 }
 
+/*
+* @brief Initializes a thread-local counter (shard) of this counter. Shard shares the 
+*        mean risk factors read by agents and person type codes; all other counters start empty.
+* @param master Counter the shard will be merged into
+*/
+void CardioCounter::initShard(const CardioCounter &master)
+{
+	param = master.param;
+	initPersonCounter(param);
+	m_meanRiskFac = master.m_meanRiskFac;
+	m_meanRiskTable = master.m_meanRiskTable;
+	m_meanWeightedSum = master.m_meanWeightedSum;
+	clearRiskFactorCounter();
+}
+
+/*
+* @brief Adds counts accumulated by a thread-local counter (shard). Shards are merged 
+*        in worker order so that the result doesn't depend on thread scheduling.
+* @param shard Thread-local counter
+*/
+void CardioCounter::merge(const CardioCounter &shard)
+{
+	Counter<CardioParams>::merge(shard);
+
+	mergeCounts(m_sumRiskFac, shard.m_sumRiskFac);
+	for(size_t i = 0; i < shard.m_sumRiskFacCount.size() && i < m_sumRiskFacCount.size(); ++i)
+		m_sumRiskFacCount[i] += shard.m_sumRiskFacCount[i];
+	mergeCounts(m_sumDiffRiskFac, shard.m_sumDiffRiskFac);
+	mergeCounts(m_totalChdRiskScore, shard.m_totalChdRiskScore);
+	mergeCounts(m_fatalChdRiskScore, shard.m_fatalChdRiskScore);
+
+	mergeCounts(m_totChdDeathsPerYear, shard.m_totChdDeathsPerYear);
+	mergeCounts(m_totChdDeathsByRaceGender, shard.m_totChdDeathsByRaceGender);
+	mergeCounts(m_totYLL, shard.m_totYLL);
+
+	mergeCounts(m_statinUsage, shard.m_statinUsage);
+	mergeCounts(m_statinEligibles, shard.m_statinEligibles);
+
+	mergeCounts(proportionSmokeChange, shard.proportionSmokeChange);
+	mergeCounts(countSmokers, shard.countSmokers);
+}
+
+/*
+* @brief Initializes counter of an intervention scenario run concurrently with other scenarios.
+*        Scenario starts from the state of the model counter (person counts, mean risk factors);
+*        outcome totals start empty and are added to the model counter by mergeOutcomes.
+* @param master Model counter
+*/
+void CardioCounter::initScenario(const CardioCounter &master)
+{
+	*this = master;
+	clearOutcomeCounter();
+}
+
+/*
+* @brief Adds outcome totals of a scenario counter (see initScenario) or of the counter of a trial
+* @param scenario Counter of an intervention scenario or a trial
+*/
+void CardioCounter::mergeOutcomes(const CardioCounter &scenario)
+{
+	mergeCounts(m_totalMeanRiskFactors, scenario.m_totalMeanRiskFactors);
+	mergeCounts(m_stdDevRiskFac, scenario.m_stdDevRiskFac);
+	mergeCounts(m_totalFraminghamRisk, scenario.m_totalFraminghamRisk);
+	mergeCounts(m_totalSCORERisk, scenario.m_totalSCORERisk);
+	mergeCounts(m_popTotalsByRaceGender, scenario.m_popTotalsByRaceGender);
+	mergeCounts(m_popTotalsRaceGenderEdu, scenario.m_popTotalsRaceGenderEdu);
+
+	mergeCounts(m_totChdDeathsByRaceGender, scenario.m_totChdDeathsByRaceGender);
+	mergeCounts(m_totYLL, scenario.m_totYLL);
+
+	mergeCounts(m_statinUsage, scenario.m_statinUsage);
+	mergeCounts(m_statinEligibles, scenario.m_statinEligibles);
+
+	mergeCounts(proportionSmokeChange, scenario.proportionSmokeChange);
+	mergeCounts(avgPropSmokeChange, scenario.avgPropSmokeChange);
+	mergeCounts(countSmokers, scenario.countSmokers);
+}
+
 void CardioCounter::clearRiskFactor()
 {
 	clearRiskFactorCounter();
@@ -76,14 +185,34 @@ void CardioCounter::addRiskFactorDifference(std::string timeFrame, std::string a
 	m_sumDiffRiskFac[timeFrame][agentType][riskType] += (diff * diff);
 }
 
-void CardioCounter::addTenYearTotalCHDRisk(std::string timeFrame, std::string agentType1, std::string agentType2, double p)
+/*
+* @brief Adds 10-year total CHD risk of an agent to streaming statistics of its race-gender type
+* @param timeFrame Before or after intervention period
+* @param typeCode Race-gender type code (see getTypeCode)
+* @param p 10-year total CHD risk
+*/
+void CardioCounter::addTenYearTotalCHDRisk(std::string timeFrame, int typeCode, double p)
 {
-	m_totalChdRiskScore[timeFrame][agentType1][agentType2].push_back(p);
+	CHDRiskScores &scores = m_totalChdRiskScore[timeFrame];
+	if(scores.empty())
+		scores.resize(NHANES::Org::_size()*NHANES::Sex::_size());
+
+	scores[typeCode].add(p);
 }
 
-void CardioCounter::addTenYearFatalCHDRisk(std::string timeFrame, std::string agentType1, std::string agentType2, double p)
+/*
+* @brief Adds 10-year fatal CHD risk of an agent to streaming statistics of its race-gender type
+* @param timeFrame Before or after intervention period
+* @param typeCode Race-gender type code (see getTypeCode)
+* @param p 10-year fatal CHD risk
+*/
+void CardioCounter::addTenYearFatalCHDRisk(std::string timeFrame, int typeCode, double p)
 {
-	m_fatalChdRiskScore[timeFrame][agentType1][agentType2].push_back(p);
+	CHDRiskScores &scores = m_fatalChdRiskScore[timeFrame];
+	if(scores.empty())
+		scores.resize(NHANES::Org::_size()*NHANES::Sex::_size());
+
+	scores[typeCode].add(p);
 }
 
 void CardioCounter::addIncome(std::string race, double income)
@@ -91,9 +220,10 @@ void CardioCounter::addIncome(std::string race, double income)
 	m_incomeByRace[race].push_back(income);
 }
 
-void CardioCounter::addRiskFactors(CardioAgent *agent, std::string agentType1, std::string agentType2)
+void CardioCounter::addRiskFactors(CardioAgent *agent)
 {
-	accumulateRiskFacs(agent, agentType1, agentType2);
+	accumulateRiskFacs(agent, getTypeCode(agent->getNHANESOrigin(), agent->getSex()));
+	accumulateRiskFacs(agent, getTypeCode(agent->getNHANESOrigin(), agent->getSex(), agent->getNHANESEduCat()));
 }
 
 void CardioCounter::addStatinsUsage(CardioAgent *agent, std::string agentType, std::string timeFrame, int intervention, int statinsType, int taxType, bool isEduPresent)
@@ -114,6 +244,26 @@ void CardioCounter::addStatinsUsage(CardioAgent *agent, std::string agentType, s
 	}
 }
 
+/*
+* @brief Adds number of statin users of an agent type at once (see processChdEvents of CardioModel)
+* @param agentType agent type by race gender
+* @param timeFrame Time period after the intervention
+* @param intervention Index of intervention
+* @param statinsType Type of statins intervention
+* @param taxType Type of smoking tax intervention
+* @param isEduPresent True if education intervention is present
+* @param numUsers Number of agents on statin
+*/
+void CardioCounter::addStatinsUsage(std::string agentType, std::string timeFrame, int intervention, int statinsType, int taxType, bool isEduPresent, int numUsers)
+{
+	if((intervention == (int)EET::Interventions::Statins || intervention == (int)EET::Interventions::Tax_Statins) || intervention == (int)EET::EduIntervention::Education)
+	{
+		std::string s_intervention = param->getInterventionType(intervention, statinsType, taxType, isEduPresent);
+		if(numUsers > 0)
+			m_statinUsage[s_intervention][agentType][timeFrame] += numUsers;
+	}
+}
+
 /*
 * @brief Counter for CHD deaths for a given intervention by year and agent type
 * @param intervention Intervention type
@@ -194,6 +344,61 @@ void CardioCounter::computeMeanRisk(std::string timeFrame)
 {
 	m_meanRiskFac[timeFrame].clear();
 	m_meanRiskFac[timeFrame] = computeMean();
+
+	computeMeanTable(timeFrame);
+}
+
+/*
+* @brief Copies mean risk factors of a time frame into a table indexed by type code and
+*        computes Framingham weighted sum at the mean risk factors of each race-gender type.
+*        Agents of the same type share these values, so they are computed once here
+*        instead of for every agent.
+* @param timeFrame Before or after intervention period
+*/
+void CardioCounter::computeMeanTable(std::string timeFrame)
+{
+	const EET::Cardio *cardio = param->getCardioParam();
+	const RiskFacMap &meanRisk = m_meanRiskFac[timeFrame];
+
+	int num_raceGender = NHANES::Org::_size()*NHANES::Sex::_size();
+	int num_types = getTypeCode(NHANES::Org::_size(), NHANES::Sex::_size(), NHANES::Edu::_size()) + 1;
+
+	SumRiskFactors &table = m_meanRiskTable[timeFrame];
+	table.assign(num_types, std::vector<double>(NHANES::RiskFac::_size(), 0));
+
+	std::vector<double> &meanSum = m_meanWeightedSum[timeFrame];
+	meanSum.assign(num_raceGender, 0);
+
+	for(auto org : NHANES::Org::_values())
+	{
+		for(auto sex : NHANES::Sex::_values())
+		{
+			std::string agent_type = std::to_string(org) + std::to_string(sex);
+			int typeCode = getTypeCode(org, sex);
+			for(auto risk : NHANES::RiskFac::_values())
+				table[typeCode][risk] = meanRisk.at(agent_type).at(risk);
+
+			for(auto edu : NHANES::Edu::_values())
+			{
+				std::string agent_type_edu = "edu" + agent_type + std::to_string(edu);
+				int typeCodeEdu = getTypeCode(org, sex, edu);
+				for(auto risk : NHANES::RiskFac::_values())
+					table[typeCodeEdu][risk] = meanRisk.at(agent_type_edu).at(risk);
+			}
+
+			const std::vector<double> &mean = table[typeCode];
+			const EET::Framingham &b = (sex == (int)NHANES::Sex::Male) ? cardio->male_coeff : cardio->female_coeff;
+
+			double logAge = log(mean[NHANES::RiskFac::Age]);
+			double logTchols = log(mean[NHANES::RiskFac::totalChols]);
+			double percentSmoking = mean[NHANES::RiskFac::SmokingStat];
+
+			meanSum[typeCode] = b.age*logAge + b.tchols*logTchols + b.hdl*log(mean[NHANES::RiskFac::HdlChols])
+				+ b.sbp*log(mean[NHANES::RiskFac::SystolicBp]) + b.htn*mean[NHANES::RiskFac::HyperTension] + b.smoker*percentSmoking
+				+ b.age_tchols*logAge*logTchols + b.age_smoker*logAge*percentSmoking
+				+ b.sq_age*logAge*logAge;
+		}
+	}
 }
 
 void CardioCounter::sumOutcomes(std::string intervention)
@@ -205,19 +410,101 @@ void CardioCounter::sumOutcomes(std::string intervention)
 }
 
 
-void CardioCounter::accumulateRiskFacs(CardioAgent *agent, std::string agentType1, std::string agentType2)
+/*
+* @brief Adds risk factors of an agent to the risk factor sums of a type
+* @param agent Agent
+* @param typeCode Race-gender or race-gender-education type code (see getTypeCode)
+*/
+void CardioCounter::accumulateRiskFacs(CardioAgent *agent, int typeCode)
 {
-	double risk_factor = -1;
+	std::vector<double> &sumRisks = m_sumRiskFac[typeCode];
 	for(auto risk : NHANES::RiskFac::_values())
-	{
-		risk_factor = agent->getRiskFactor(risk);
+		sumRisks[risk] += agent->getRiskFactor(risk);
 
-		m_sumRiskFac[agentType1][risk] += risk_factor;
-		m_sumRiskFac[agentType2][risk] += risk_factor;
+	m_sumRiskFacCount[typeCode]++;
+}
+
+/*
+* @brief Registers agent types counted by agents: race-gender ("11") and race-gender-education 
+*        ("edu111") types, stored by their race-gender(-education) type code
+*/
+void CardioCounter::registerAgentTypes()
+{
+	int num_types = getTypeCode(NHANES::Org::_size(), NHANES::Sex::_size(), NHANES::Edu::_size()) + 1;
+	m_agentTypeCodes.assign(num_types, -1);
+
+	for(auto org : NHANES::Org::_values())
+	{
+		for(auto sex : NHANES::Sex::_values())
+		{
+			std::string agentType = std::to_string(org) + std::to_string(sex);
+			m_agentTypeCodes[getTypeCode(org, sex)] = registerPersonType(agentType);
 
+			for(auto edu : NHANES::Edu::_values())
+				m_agentTypeCodes[getTypeCode(org, sex, edu)] = registerPersonType("edu" + agentType + std::to_string(edu));
+		}
 	}
 }
 
+/*
+* @brief Counts agent by race and gender
+* @param org NHANES origin
+* @param sex Sex
+*/
+void CardioCounter::addRaceGenderCount(int org, int sex)
+{
+	int code = -1;
+	if(org >= 1 && org <= (int)NHANES::Org::_size() && sex >= 1 && sex <= (int)NHANES::Sex::_size())
+		code = getTableCode(m_agentTypeCodes, 0, getTypeCode(org, sex), m_agentTypeCodes.size());
+
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount(org, sex);
+}
+
+/*
+* @brief Counts agent by race, gender and education - used to calculate education difference
+* @param org NHANES origin
+* @param sex Sex
+* @param edu NHANES education category
+*/
+void CardioCounter::addRaceGenderEduCount(int org, int sex, int edu)
+{
+	int code = -1;
+	if(org >= 1 && org <= (int)NHANES::Org::_size() && sex >= 1 && sex <= (int)NHANES::Sex::_size() 
+		&& edu >= 1 && edu <= (int)NHANES::Edu::_size())
+		code = getTableCode(m_agentTypeCodes, 0, getTypeCode(org, sex, edu), m_agentTypeCodes.size());
+
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("edu" + std::to_string(org) + std::to_string(sex) + std::to_string(edu));
+}
+
+/*
+* @brief Returns dense code of race-gender type. Codes range over [0, num_org*num_sex).
+* @param org NHANES origin
+* @param sex Sex
+*/
+int CardioCounter::getTypeCode(int org, int sex)
+{
+	return (org-1)*NHANES::Sex::_size() + (sex-1);
+}
+
+/*
+* @brief Returns dense code of race-gender-education type. Codes follow race-gender 
+*        codes and range over [num_org*num_sex, num_org*num_sex*(num_edu+1)).
+* @param org NHANES origin
+* @param sex Sex
+* @param edu NHANES education category
+*/
+int CardioCounter::getTypeCode(int org, int sex, int edu)
+{
+	int num_raceGender = NHANES::Org::_size()*NHANES::Sex::_size();
+	return num_raceGender + getTypeCode(org, sex)*NHANES::Edu::_size() + (edu-1);
+}
+
 CardioCounter::RiskFacMap CardioCounter::computeMean()
 {
 	RiskFacMap meanRisk;
@@ -226,12 +513,12 @@ CardioCounter::RiskFacMap CardioCounter::computeMean()
 		for(auto sex : NHANES::Sex::_values())
 		{
 			std::string agent_type1 = std::to_string(org) + std::to_string(sex);
-			computeMean(meanRisk, agent_type1);
+			computeMean(meanRisk, agent_type1, getTypeCode(org, sex));
 
 			for(auto edu : NHANES::Edu::_values())
 			{
 				std::string agent_type2 =  "edu" + agent_type1 + std::to_string(edu);
-				computeMean(meanRisk, agent_type2);
+				computeMean(meanRisk, agent_type2, getTypeCode(org, sex, edu));
 			}
 		}
 
@@ -240,14 +527,14 @@ CardioCounter::RiskFacMap CardioCounter::computeMean()
 	return meanRisk;
 }
 
-void CardioCounter::computeMean(RiskFacMap &mean_risks, std::string agent_type)
+void CardioCounter::computeMean(RiskFacMap &mean_risks, std::string agent_type, int typeCode)
 {
-	int agent_pop = m_personCount[agent_type].size();
-	if(m_personCount.count(agent_type) > 0 && m_sumRiskFac.count(agent_type) > 0)
+	int agent_pop = getPersonCount(agent_type);
+	if(hasPersonType(agent_type) && m_sumRiskFacCount[typeCode] > 0)
 	{
 		for(auto risk : NHANES::RiskFac::_values())
 		{
-			mean_risks[agent_type][risk] = m_sumRiskFac[agent_type][risk]/agent_pop;
+			mean_risks[agent_type][risk] = m_sumRiskFac[typeCode][risk]/agent_pop;
 		}
 	}
 	else
@@ -281,14 +568,14 @@ void CardioCounter::sumMeanRiskFactors(std::string intervention)
 
 		if(m_raceGender.count(agent_type) > 0)
 		{
-			if(m_personCount.count(agent_type) > 0)
-				m_popTotalsByRaceGender[intervention][agent_type] += m_personCount[agent_type].size();
+			if(hasPersonType(agent_type))
+				m_popTotalsByRaceGender[intervention][agent_type] += getPersonCount(agent_type);
 
 			for(auto edu : NHANES::Edu::_values())
 			{
 				std::string agentTypeByEdu = "edu" + agent_type + std::to_string(edu);
-				if(m_personCount.count(agentTypeByEdu) > 0)
-					m_popTotalsRaceGenderEdu[intervention][agentTypeByEdu] += m_personCount[agentTypeByEdu].size();
+				if(hasPersonType(agentTypeByEdu))
+					m_popTotalsRaceGenderEdu[intervention][agentTypeByEdu] += getPersonCount(agentTypeByEdu);
 			}
 
 			for(auto map2 = map1->second.begin(); map2 != map1->second.end(); ++map2)
@@ -321,7 +608,7 @@ void CardioCounter::sumStdDevRiskFactors(std::string intervention)
 		for(auto map2 = map1->second.begin(); map2 != map1->second.end(); ++map2)
 		{
 			std::string agentType = map2->first;
-			int pop = m_personCount[agentType].size();
+			int pop = getPersonCount(agentType);
 			
 			for(auto risk : NHANES::RiskFac::_values())
 			{
@@ -362,25 +649,22 @@ void CardioCounter::sumTenYearFatalCHDRisk(std::string intervention)
 	}
 }
 
-void CardioCounter::sumTenYearCHDRisk(std::map<std::string, CHDRiskScores> & m_tenYearCHDRisk, TotalCHDScores &m_total, std::string intervention, std::string timeFrame)
+void CardioCounter::sumTenYearCHDRisk(const CHDRiskScores &m_tenYearCHDRisk, TotalCHDScores &m_total, std::string intervention, std::string timeFrame)
 {
-	double weightedMean;
-	for(auto map = m_tenYearCHDRisk.begin();  map != m_tenYearCHDRisk.end(); ++map)
-	{
-		std::string agent_type = map->first;
-		CHDRiskScores chd_risk_score(map->second);
-		
-		double sum = 0;
-		int popCount = 0;
+	if(m_tenYearCHDRisk.empty())
+		return;
 
-		for(auto sub_map = chd_risk_score.begin(); sub_map != chd_risk_score.end(); ++sub_map)
+	for(auto org : NHANES::Org::_values())
+	{
+		for(auto sex : NHANES::Sex::_values())
 		{
-			sum += std::accumulate(sub_map->second.begin(), sub_map->second.end(), 0.0);
-			popCount += sub_map->second.size();
-		}
+			const RunningStat &chd_risk_score = m_tenYearCHDRisk[getTypeCode(org, sex)];
+			if(chd_risk_score.count == 0)
+				continue;
 
-		weightedMean = sum/popCount;
-		m_total[intervention][timeFrame][agent_type] += weightedMean;
+			std::string agent_type = std::to_string(org) + std::to_string(sex);
+			m_total[intervention][timeFrame][agent_type] += chd_risk_score.mean;
+		}
 	}
 }
 
@@ -395,6 +679,41 @@ double CardioCounter::getMeanRiskFactor(std::string timeFrame, std::string perso
 	}
 }
 
+/*
+* @brief Returns mean risk factor of a type from the table filled by computeMeanRisk
+* @param timeFrame Before or after intervention period
+* @param typeCode Race-gender or race-gender-education type code (see getTypeCode)
+* @param risk_type Risk factor
+*/
+double CardioCounter::getMeanRiskFactor(std::string timeFrame, int typeCode, int risk_type) const
+{
+	auto table = m_meanRiskTable.find(timeFrame);
+	if(table != m_meanRiskTable.end() && typeCode < (int)table->second.size())
+		return table->second[typeCode][risk_type];
+	else
+	{
+		std::cout << "Error: Cannot return risk# " << risk_type << " for type code " << typeCode << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+}
+
+/*
+* @brief Returns Framingham weighted sum at mean risk factors of a race-gender type
+* @param timeFrame Before or after intervention period
+* @param typeCode Race-gender type code (see getTypeCode)
+*/
+double CardioCounter::getMeanWeightedSum(std::string timeFrame, int typeCode) const
+{
+	auto meanSum = m_meanWeightedSum.find(timeFrame);
+	if(meanSum != m_meanWeightedSum.end() && typeCode < (int)meanSum->second.size())
+		return meanSum->second[typeCode];
+	else
+	{
+		std::cout << "Error: Cannot return mean weighted sum for type code " << typeCode << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+}
+
 double CardioCounter::getChdDeaths(std::string interventionType, int year)
 {
 	std::string s_id = interventionType;
@@ -872,7 +1191,30 @@ std::string CardioCounter::getYear(std::string timeFrame, std::string sep)
 
 void CardioCounter::clearRiskFactorCounter()
 {
-	m_sumRiskFac.clear();
+	int num_types = getTypeCode(NHANES::Org::_size(), NHANES::Sex::_size(), NHANES::Edu::_size()) + 1;
+
+	m_sumRiskFac.assign(num_types, std::vector<double>(NHANES::RiskFac::_size(), 0));
+	m_sumRiskFacCount.assign(num_types, 0);
+}
+
+void CardioCounter::clearOutcomeCounter()
+{
+	m_totalMeanRiskFactors.clear();
+	m_stdDevRiskFac.clear();
+	m_totalFraminghamRisk.clear();
+	m_totalSCORERisk.clear();
+	m_popTotalsByRaceGender.clear();
+	m_popTotalsRaceGenderEdu.clear();
+
+	m_totChdDeathsByRaceGender.clear();
+	m_totYLL.clear();
+
+	m_statinUsage.clear();
+	m_statinEligibles.clear();
+
+	proportionSmokeChange.clear();
+	avgPropSmokeChange.clear();
+	countSmokers.clear();
 }
 
 void CardioCounter::clearCHDRiskCounter(std::string timeFrame)
@@ -18,11 +18,14 @@
 #include "CardioCounter.h"
 #include "ElapsedTime.h"
 #include "CardioParams.h"
+#include "ParallelBlocks.h"
+
+#include <limits>
 
 /*
 * @brief Default class constructor
 */
-CardioModel::CardioModel() 
+CardioModel::CardioModel() : random(NULL), baselineRisk(false)
 {
 	
 }
@@ -35,11 +38,24 @@ CardioModel::CardioModel()
 * @param geoLvl Geographic orientation (MSAs or US states)
 */
 CardioModel::CardioModel(const char *inDir, const char *outDir, int simType, int geoLvl) 
-	: PopBrewer(new CardioParams(inDir, outDir, simType, geoLvl))
+	: PopBrewer(new CardioParams(inDir, outDir, simType, geoLvl)), random(NULL), baselineRisk(false)
 {
 	import();
 }
 
+/*
+* @brief Class constructor of a single trial. Trial owns a copy of the parameters,
+*        its counter and a random stream seeded with the given seed.
+* @param param Parameters of the model running the trials
+* @param seed Seed of random stream of the trial
+*/
+CardioModel::CardioModel(const CardioParams &param, unsigned int seed) : baselineRisk(false)
+{
+	parameters = std::make_shared<CardioParams>(param);
+	count = new CardioCounter(parameters);
+	random = new Random(seed);
+}
+
 /*
 * @brief Class destructor
 */
@@ -57,6 +73,11 @@ void CardioModel::start()
 /*
 * @brief Starts the simulation (population generation and model execution).
 *        Runs simulation for n trials and outputs the results of the simulation.
+*        Each trial runs on its own model (population, parameters, counter) with a random
+*        stream seeded by the master seed plus the trial index; up to 'trial_threads' trials
+*        run concurrently. Trial counters are merged in trial order, so results do not
+*        depend on 'trial_threads'. Loops split over 'threads' within a trial seed one
+*        stream per block, so they do depend on that setting.
 * @param stateID State's geo ID
 */
 void CardioModel::start(int stateID)
@@ -64,7 +85,6 @@ void CardioModel::start(int stateID)
 	if(parameters != NULL)
 	{
 		count = new CardioCounter(parameters);
-		random = new Random;
 	}
 	else{
 		std::cout << "Error: Parameters are not initialized!" << std::endl;
@@ -72,24 +92,52 @@ void CardioModel::start(int stateID)
 	}
 
 	int num_trials = parameters->getCardioParam()->num_trials;
+	int trial_threads = parameters->getNumTrialThreads();
+	unsigned int master_seed = (parameters->getSeed() > 0) ? parameters->getSeed() : (unsigned int)time(NULL);
 	
 	Area<CardioParams> *state = &m_geoAreas.at(std::to_string(stateID));
 
 	std::string state_name = state->getAreaName();
+	state->createIPU();
 	
-	for(size_t i = 0; i < num_trials; ++i)
+	for(int first = 0; first < num_trials; first += trial_threads)
 	{
-		std::cout << std::endl << "Simulation #" << i+1 << std::endl;
+		int last = std::min(num_trials, first + trial_threads);
 
-		createPopulation(state);
-		
-		runModel();
-		clearList();
+		std::vector<CardioModel *> trials;
+		for(int i = first; i < last; ++i)
+			trials.push_back(new CardioModel(*parameters, master_seed + i));
+
+		runBlocks((int)trials.size(), 
+			[&](int t) {
+				trials[t]->runTrial(state, first + t);
+			});
+
+		for(size_t t = 0; t < trials.size(); ++t)
+		{
+			count->mergeOutcomes(*trials[t]->getCounter());
+			delete trials[t];
+		}
 	}
 
 	count->output(state->getAreaAbbreviation());
 }
 
+/*
+* @brief Runs a single trial: creates population, runs intervention scenarios and clears the population
+* @param area State for which population is created
+* @param trial Index of the trial
+*/
+void CardioModel::runTrial(Area<CardioParams> *area, int trial)
+{
+	std::cout << std::endl << "Simulation #" << trial+1 << std::endl;
+
+	createPopulation(area);
+	
+	runModel();
+	clearList();
+}
+
 /*
 * @brief Invokes a method to:
 *        1. Create a population for a given state.
@@ -100,10 +148,12 @@ void CardioModel::start(int stateID)
 void CardioModel::createPopulation(Area<CardioParams> *area)
 {
 	std::cout << "Creating Population for " << area->getAreaName() << std::endl;
-	area->createAgents(this);
+	area->createAgents(this, random->random_int(1, std::numeric_limits<int>::max()));
 
 	computeEducationDifference();
 	setRiskFactors();
+
+	baselineRisk = false;
 }
 
 /*
@@ -158,25 +208,18 @@ void CardioModel::addHousehold(const HouseholdPums<CardioParams> *h, int countHH
 
 /*
 * @brief Adds agents with age 45-64 to the list of agents.
-*        Adds agents to the map based on race, gender, age cat and edu cat
 * @param p PUMS person from Person-level PUMS file for a given state
 */
 void CardioModel::addAgent(const PersonPums<CardioParams> *p)
 {
 	//Including ARIC study cohort age range (45-54)
-	std::string agent_type;
-
 	if(p->getAge() >= 45 && p->getAge() < 65)
 	{
 		if(p->getOrigin() == ACS::Origin::WhiteNH || p->getOrigin() == ACS::Origin::BlackNH)
 		{
 			CardioAgent *agent = new CardioAgent(p, parameters, count, random);
 
-			//agent_type = agent->getAgentType1();
-			agent_type = agent->getAgentType5();
-
 			agentList.push_back(agent);
-			agentsPtrMap.insert(std::make_pair(agent_type, agent));
 		}
 	}
 }
@@ -187,6 +230,9 @@ void CardioModel::addAgent(const PersonPums<CardioParams> *p)
 *        Systolic blood pressure, smoking status, statin medication status, hypertension medication status.
 *        Risk factors are stratified by agent type (by race, gender, age cat and edu cat) and risk strata.
 *        Risk strata are identified based on the presence or absence of individual risk factors.
+*        Agents are grouped into contiguous ranges by agent type (counting sort by type code), and 
+*        each agent type is assigned with its own random stream. With more than one thread, agent 
+*        types are split into contiguous blocks of about equal number of agents (see runBlocks).
 */
 void CardioModel::setRiskFactors()
 {
@@ -195,8 +241,87 @@ void CardioModel::setRiskFactors()
 	//Clear risk factor every simulation trial
 	count->clearRiskFactor();
 
+	int num_types = parameters->getNumRiskTypes();
+	size_t num_agents = agentList.size();
+
+	//Group agents by agent type, preserving their order within a type
+	std::vector<int> typeCodes(num_agents);
+	std::vector<size_t> typeOffsets(num_types+1, 0);
+	for(size_t i = 0; i < num_agents; ++i)
+	{
+		CardioAgent *agent = agentList[i];
+		typeCodes[i] = parameters->getRiskTypeCode(agent->getNHANESOrigin(), agent->getSex(), 
+			agent->getNHANESAgeCat(), agent->getNHANESEduCat());
+
+		if(typeCodes[i] < 0)
+		{
+			std::cout << "Error: Agent type " << agent->getAgentType5() << " doesn't exist!" << std::endl;
+			exit(EXIT_SUCCESS);
+		}
+
+		typeOffsets[typeCodes[i]+1]++;
+	}
+
+	for(int type = 0; type < num_types; ++type)
+		typeOffsets[type+1] += typeOffsets[type];
+
+	AgentList agentsByType(num_agents);
+	std::vector<size_t> next(typeOffsets.begin(), typeOffsets.end()-1);
+	for(size_t i = 0; i < num_agents; ++i)
+		agentsByType[next[typeCodes[i]]++] = agentList[i];
+
+	//Random stream of each agent type
+	std::vector<unsigned int> seeds(num_types);
+	for(int type = 0; type < num_types; ++type)
+		seeds[type] = random->random_int(1, std::numeric_limits<int>::max());
+
+	int num_threads = parameters->getNumThreads();
+	if(num_threads > 1)
+	{
+		//agent types of block t are [blockTypes[t], blockTypes[t+1]); last type of a block 
+		//reaches (t+1)/num_threads of all agents
+		std::vector<int> blockTypes(num_threads+1, 0);
+		for(int t = 0; t < num_threads; ++t)
+		{
+			size_t blockEnd = (num_agents*(t+1))/num_threads;
+			int lastType = blockTypes[t];
+			while(lastType < num_types && (typeOffsets[lastType] < blockEnd || t == num_threads-1))
+				lastType++;
+
+			blockTypes[t+1] = lastType;
+		}
+
+		//agent types draw from their own streams, so blocks are not seeded
+		runBlocks<CardioCounter>(num_threads, NULL, count, 
+			[&](int t, unsigned int, CardioCounter *shard) {
+				assignRiskFactorsBlock(&agentsByType, &typeOffsets, &seeds, blockTypes[t], blockTypes[t+1], shard);
+			});
+	}
+	else
+	{
+		assignRiskFactorsBlock(&agentsByType, &typeOffsets, &seeds, 0, num_types, count);
+	}
+
+	//Computes mean of risk factors before the intervention
+	count->computeMeanRisk(parameters->beforeIntervention());
+
+	std::cout << "\nAssignment Complete!\n " << std::endl;
+}
+
+/*
+* @brief Assigns NHANES risk factors to agents of agent types in [firstType, lastType)
+* @param agentsByType Agents grouped by agent type
+* @param typeOffsets Index of first agent of each agent type in agentsByType
+* @param seeds Seed of random stream of each agent type
+* @param firstType Code of first agent type of the block
+* @param lastType Code past the last agent type of the block
+* @param shard Counter agents of the block report to
+*/
+void CardioModel::assignRiskFactorsBlock(const AgentList *agentsByType, const std::vector<size_t> *typeOffsets, const std::vector<unsigned int> *seeds, 
+	int firstType, int lastType, CardioCounter *shard)
+{
 	//NHANES risk factors by agent type
-	AgentStrataRiskMap m_riskFactors(*parameters->getRiskFactorMap());
+	const AgentStrataRiskMap *m_riskFactors = parameters->getRiskFactorMap();
 
 	//Tuple consisting of weight, strata and risk factor
 	WeightStrataRiskTuple risk_tuple;
@@ -207,17 +332,20 @@ void CardioModel::setRiskFactors()
 
 	EET::RiskFactors risk_factors;
 
-	for(auto map = m_riskFactors.begin(); map != m_riskFactors.end(); ++map)
+	for(int type = firstType; type < lastType; ++type)
 	{
-		std::string agent_type = map->first;
+		size_t first = typeOffsets->at(type);
+		size_t last = typeOffsets->at(type+1);
 
-		double agent_pop = agentsPtrMap.count(agent_type);
+		double agent_pop = (double)(last - first);
 		if(agent_pop == 0)
 			continue;
 
+		auto map = m_riskFactors->find(agentsByType->at(first)->getAgentType5());
+		if(map == m_riskFactors->end())
+			continue;
+
 		double adj = 0;
-		
-		std::cout << "Risk factor assignment for person type: " << agent_type << std::endl;
 
 		//Compute weight (number of agents with a given risk strata and risk factor)
 		for(auto risk = map->second.begin(); risk != map->second.end(); ++risk)
@@ -243,9 +371,10 @@ void CardioModel::setRiskFactors()
 			exit(EXIT_SUCCESS);
 		}
 
-		boost::range::random_shuffle(v_riskFactors);
+		Random rand(seeds->at(type));
+		auto randomIdx = [&rand](int n){ return rand.random_int(0, n-1); };
+		boost::range::random_shuffle(v_riskFactors, randomIdx);
 
-		auto agents = agentsPtrMap.equal_range(agent_type);
 		int idx = 0;
 
 		risk_tuple = v_riskFactors.at(idx);
@@ -254,8 +383,10 @@ void CardioModel::setRiskFactors()
 		risk_strata = std::get<1>(risk_tuple);
 		risk_factors = std::get<2>(risk_tuple);
 
-		for(auto agent = agents.first; agent != agents.second; ++agent)
+		for(size_t i = first; i < last; ++i)
 		{
+			CardioAgent *agent = agentsByType->at(i);
+
 			if(agents_per_strata == 0)
 			{
 				while(true)
@@ -284,18 +415,16 @@ void CardioModel::setRiskFactors()
 			
 			if(agents_per_strata > 0)
 			{
-				agent->second->setRiskFactors(risk_strata, risk_factors);
+				agent->setCounter(shard);
+				agent->setRiskFactors(risk_strata, risk_factors);
+				agent->setCounter(count);
+
 				agents_per_strata--;
 			}
 		}
 
 		v_riskFactors.clear();
 	}
-
-	//Computes mean of risk factors before the intervention
-	count->computeMeanRisk(parameters->beforeIntervention());
-
-	std::cout << "\nAssignment Complete!\n " << std::endl;
 }
 
 /*
@@ -304,6 +433,8 @@ void CardioModel::setRiskFactors()
 *        2. Smoking Tax intervention
 *        3. Statins Intervention
 *        4. Smoking Tax + Statins Intervention
+*        Scenarios that start from the same baseline are queued and run together 
+*        (see runSubModels).
 */
 void CardioModel::runModel()
 {
@@ -338,6 +469,8 @@ void CardioModel::runModel()
 				break;
 			}
 		}
+
+		runSubModels();
 	}
 }
 
@@ -393,7 +526,9 @@ void CardioModel::educationIntervention(int id, bool isEducationPresent)
 	std::string eduInterventionName = getEducationInterventionName(id);
 	std::cout << "\nStarting " << eduInterventionName << " Intervention\n" << std::endl;
 
+	//education intervention changes the baseline of the scenarios that follow it
 	runSubModels(eduInterventionName, id, 0, 0, 1, isEducationPresent);
+	runSubModels();
 }
 
 /*
@@ -429,6 +564,7 @@ void CardioModel::taxIntervention(int id, bool isEducationPresent)
 
 		}
 
+		runSubModels();
 		count->computeSmokeChange();
 	}
 }
@@ -477,12 +613,7 @@ void CardioModel::taxStatinsIntervention(int id, bool isEducationPresent)
 }
 
 /*
-* @brief Sub-models of CHD model
-*        1. Compute 10 Year risk of CHD (Total and Fatal) before intervention
-*        2. Execute intervention for 2 years
-*        3. Compute 10 Year risk of CHD after the intervention
-*        4. Process the CHD events based on predicted 10-year risk
-*        5. Reset the risk factor attributes
+* @brief Queues the sub-models of an intervention scenario. Queued scenarios are run by runSubModels().
 * @param interventionName Name of the intervention
 * @param interventionId Intervention index
 * @param taxType Type of the tax (2, 3, 4, or 5 dollar tax)
@@ -492,63 +623,237 @@ void CardioModel::taxStatinsIntervention(int id, bool isEducationPresent)
 */
 void CardioModel::runSubModels(std::string interventionName, int interventionId, int taxType, int statinsType, int interventionYears, bool isEducationPresent)
 {
-	computeTenYearCHDRisk(parameters->beforeIntervention());
-	for(int currYear = 0; currYear < interventionYears; ++currYear)
+	SubModel subModel = {interventionName, interventionId, taxType, statinsType, interventionYears, isEducationPresent};
+	subModels.push_back(subModel);
+}
+
+/*
+* @brief Runs queued scenarios. All of them start from the same baseline population (agents
+*        are reset after each scenario), so 10-year CHD risk before the intervention is 
+*        computed once for the baseline and reused by every scenario: agents restore it on 
+*        reset and the counter keeps its before-intervention totals.
+*        With more than one thread the scenarios run concurrently: each worker (lane) runs its
+*        scenarios on its own copy of the agents, and each scenario records to its own counter
+*        and random stream. Scenario counters are merged into the model counter in queue order
+*        once all lanes are complete.
+*/
+void CardioModel::runSubModels()
+{
+	int num_threads = parameters->getNumThreads();
+	if(!subModels.empty() && !baselineRisk)
+	{
+		Scenario scenario = {&agentList, count, random, &population, num_threads};
+		computeTenYearCHDRisk(scenario, parameters->beforeIntervention());
+		baselineRisk = true;
+	}
+
+	if(num_threads > 1 && subModels.size() > 1)
+	{
+		size_t numLanes = std::min((size_t)num_threads, subModels.size());
+
+		std::vector<unsigned int> seeds;
+		std::vector<CardioCounter> scenarioCounts(subModels.size());
+		for(size_t i = 0; i < subModels.size(); ++i)
+		{
+			seeds.push_back(random->random_int(1, std::numeric_limits<int>::max()));
+			scenarioCounts[i].initScenario(*count);
+		}
+
+		runBlocks((int)numLanes, 
+			[&](int lane) {
+				runScenarios(lane, numLanes, &seeds, &scenarioCounts);
+			});
+
+		for(size_t i = 0; i < scenarioCounts.size(); ++i)
+			count->mergeOutcomes(scenarioCounts[i]);
+	}
+	else
+	{
+		Scenario scenario = {&agentList, count, random, &population, num_threads};
+		for(size_t i = 0; i < subModels.size(); ++i)
+			runSubModels(scenario, subModels[i]);
+	}
+
+	subModels.clear();
+}
+
+/*
+* @brief Worker running every numLanes-th queued scenario, starting at lane, on a copy of the agents.
+*        A CardioAgent is 304 bytes (g++, x86-64) and owns no heap memory, so a lane adds 
+*        304 bytes per agent. State changed by a scenario (chart, age and age cats, education, 
+*        risk strata, CHD risks, death, random streams, counter) is 144 of them, so copying 
+*        only that state would save about half and require agents to run on external state.
+* @param lane Index of the worker
+* @param numLanes Number of workers
+* @param seeds Seed of random stream of each scenario
+* @param scenarioCounts Counter of each scenario
+*/
+void CardioModel::runScenarios(size_t lane, size_t numLanes, const std::vector<unsigned int> *seeds, std::vector<CardioCounter> *scenarioCounts)
+{
+	std::vector<CardioAgent> agents;
+	AgentList laneAgents;
+	CardioPopulation lanePopulation;
+
+	agents.reserve(agentList.size());
+	for(auto agent : agentList)
+		agents.push_back(*agent);
+
+	for(size_t i = 0; i < agents.size(); ++i)
+		laneAgents.push_back(&agents[i]);
+
+	for(size_t k = lane; k < subModels.size(); k += numLanes)
+	{
+		Random rand(seeds->at(k));
+		CardioCounter *scenarioCount = &scenarioCounts->at(k);
+
+		for(auto agent : laneAgents)
+		{
+			agent->setCounter(scenarioCount);
+			agent->setRandom(&rand);
+		}
+
+		Scenario scenario = {&laneAgents, scenarioCount, &rand, &lanePopulation, 1};
+		runSubModels(scenario, subModels[k]);
+	}
+}
+
+/*
+* @brief Sub-models of CHD model
+*        1. Execute intervention for 2 years (10 Year risk of CHD before intervention
+*           is computed for the baseline by runSubModels())
+*        2. Compute 10 Year risk of CHD after the intervention
+*        3. Process the CHD events based on predicted 10-year risk
+*        4. Reset the risk factor attributes
+* @param scenario Agents, counter and random stream of the scenario
+* @param subModel Intervention scenario
+*/
+void CardioModel::runSubModels(Scenario &scenario, const SubModel &subModel)
+{
+	std::cout << "\nRunning " << subModel.interventionName << " Intervention\n" << std::endl;
+
+	for(int currYear = 0; currYear < subModel.interventionYears; ++currYear)
 	{
 		std::cout << "Year " << currYear + 1 << std::endl;
-		executeIntervention(interventionId, taxType, statinsType, currYear, isEducationPresent);
+		executeIntervention(scenario, subModel.interventionId, subModel.taxType, subModel.statinsType, currYear, subModel.isEducationPresent);
 	}
 
-	computeTenYearCHDRisk(parameters->afterIntervention());
-	processChdEvents(interventionId, taxType, statinsType, isEducationPresent);
-	resetAttributes();
+	computeTenYearCHDRisk(scenario, parameters->afterIntervention());
+	processChdEvents(scenario, subModel.interventionId, subModel.taxType, subModel.statinsType, subModel.isEducationPresent);
+	resetAttributes(scenario);
 
-	count->sumOutcomes(interventionName);
+	scenario.count->sumOutcomes(subModel.interventionName);
 
+	//charts of the baseline were updated by education intervention
+	if(subModel.interventionId == EET::EduIntervention::Education)
+		baselineRisk = false;
 }
 
 /*
-* @brief Executes a method to compute 10-year risk of CHD for each agent
+* @brief Computes 10-year risk of CHD for each agent of a scenario. Risk factors of agents are 
+*        gathered into CardioPopulation arrays and risk equations are evaluated in batch (once 
+*        per distinct risk profile if 'compress_profiles' is set in run_params.csv); agents then
+*        record their risk (and draw CHD death year after the intervention).
+*        With more than one thread, both the evaluation and the agents are split into contiguous
+*        blocks (see runBlocks).
+* @param scenario Agents, counter and random stream of the scenario
 * @param timeFrame Before or after intervention time period
 */
-void CardioModel::computeTenYearCHDRisk(std::string timeFrame)
+void CardioModel::computeTenYearCHDRisk(Scenario &scenario, std::string timeFrame)
 {
 	double waitTime = 4000; //4 seconds wait time
 	ElapsedTime timer;
 
+	AgentList &agents = *scenario.agents;
+	CardioPopulation &risks = *scenario.population;
+
 	std::cout << "Computing 10 year CHD risk " << timeFrame << "....\n" << std::endl;
-	count->clearCHDRisks(timeFrame);
+	scenario.count->clearCHDRisks(timeFrame);
 
-	int countAgent = 0;
-	for(auto agent : agentList)
+	risks.setCoefficients(parameters, scenario.count);
+	//after the intervention, only agents whose risk inputs changed are re-evaluated
+	risks.gather(&agents, parameters->compressProfiles(), timeFrame == parameters->afterIntervention());
+
+	int num_threads = scenario.numThreads;
+	if(num_threads > 1)
 	{
-		countAgent++;
+		size_t numSlots = risks.size();
+		size_t slotBlockSize = (numSlots + num_threads - 1)/num_threads;
+		runBlocks(num_threads, 
+			[&](int t) {
+				size_t first = std::min(numSlots, t*slotBlockSize);
+				risks.computeCHDRisk(first, std::min(numSlots, first + slotBlockSize));
+			});
+
+		size_t blockSize = (agents.size() + num_threads - 1)/num_threads;
+		runBlocks<CardioCounter>(num_threads, scenario.random, scenario.count, 
+			[&](int t, unsigned int seed, CardioCounter *shard) {
+				size_t first = std::min(agents.size(), t*blockSize);
+				recordCHDRiskBlock(&scenario, timeFrame, first, std::min(agents.size(), first + blockSize), seed, shard);
+			});
+
+		std::cout << "CHD Risk Score computed for " << agents.size() << " agents!" << std::endl;
+	}
+	else
+	{
+		risks.computeCHDRisk(0, risks.size());
 
-		agent->computeTenYearCHDRisk(timeFrame);
-		timer.stop();
-		if(timer.elapsed_ms() > waitTime)
+		for(size_t i = 0; i < agents.size(); ++i)
 		{
-			std::cout << "CHD Risk Score computed for " << countAgent << " agents!" << std::endl;
-			timer.start();
+			agents[i]->setTenYearCHDRisk(timeFrame, risks.getTotalCHDRisk(i), risks.getFatalCHDRisk(i));
+			timer.stop();
+			if(timer.elapsed_ms() > waitTime)
+			{
+				std::cout << "CHD Risk Score computed for " << i+1 << " agents!" << std::endl;
+				timer.start();
+			}
 		}
 	}
 
 	std::cout << "Complete!\n" << std::endl;
 }
 
+/*
+* @brief Records 10-year CHD risk computed by CardioPopulation for agents in [first, last)
+* @param scenario Agents, counter and random stream of the scenario
+* @param timeFrame Before or after intervention time period
+* @param first Index of first agent of the block
+* @param last Index past the last agent of the block
+* @param seed Seed of random stream of the worker
+* @param shard Thread-local counter
+*/
+void CardioModel::recordCHDRiskBlock(Scenario *scenario, std::string timeFrame, size_t first, size_t last, unsigned int seed, CardioCounter *shard)
+{
+	Random rand(seed);
+	const CardioPopulation *risks = scenario->population;
+
+	for(size_t i = first; i < last; ++i)
+	{
+		CardioAgent *agent = scenario->agents->at(i);
+
+		agent->setCounter(shard);
+		agent->setRandom(&rand);
+
+		agent->setTenYearCHDRisk(timeFrame, risks->getTotalCHDRisk(i), risks->getFatalCHDRisk(i));
+
+		agent->setCounter(scenario->count);
+		agent->setRandom(scenario->random);
+	}
+}
+
 /*
 * @brief Executes a method to update risk factors of each agent in response to the intervention
+* @param scenario Agents, counter and random stream of the scenario
 * @param interventionId Index of intervention
 * @param taxType Two, Three, Four or Five Dollar Smoking tax intervention
 * @param statinsType Type of statins intervention (Weak, Strong, Stronger or Strongest)
 * @param currentYear Intervention year (year 1 and year 2)
 * @param isEducationPresent True if education intervention is present
 */
-void CardioModel::executeIntervention(int interventionId, int taxType, int statinsType, int currentYear, bool isEducationPresent)
+void CardioModel::executeIntervention(Scenario &scenario, int interventionId, int taxType, int statinsType, int currentYear, bool isEducationPresent)
 {
 	//std::cout << "Starting " << intervention_name << "_Intervention\n" << std::endl;
 	std::cout << "Running intervention....\n" << std::endl;
-	count->clearRiskFactor();
+	scenario.count->clearRiskFactor();
 
 	double waitTime = 4000; //4 seconds wait time
 	ElapsedTime timer;
@@ -556,9 +861,9 @@ void CardioModel::executeIntervention(int interventionId, int taxType, int stati
 	int countAgent = 0;
 
 	if(interventionId == EET::EduIntervention::Education)
-		resetPersonCounter();
+		resetPersonCounter(scenario.count);
 
-	for(auto agent : agentList)
+	for(auto agent : *scenario.agents)
 	{
 		agent->update(interventionId, taxType, statinsType, currentYear, isEducationPresent);
 		
@@ -574,54 +879,82 @@ void CardioModel::executeIntervention(int interventionId, int taxType, int stati
 	std::cout << "Complete!\n" << std::endl;
 	
 	if(interventionId == EET::EduIntervention::Education)
-		count->computeMeanRisk(parameters->afterEducation());
+		scenario.count->computeMeanRisk(parameters->afterEducation());
 
-	count->computeMeanRisk(parameters->afterIntervention());
+	scenario.count->computeMeanRisk(parameters->afterIntervention());
 }
 
 /*
 * @brief Executes a method to process CHD event (CHD related death) over 10 year period based on 10-year 
-*        risk of Fatal CHD.
+*        risk of Fatal CHD. Agents are processed in a single pass: deaths are bucketed by year of death,
+*        and agents on statin are counted by race-gender type and last year alive, so statin usage of
+*        each year is the number of users alive through that year.
+* @param scenario Agents, counter and random stream of the scenario
 * @param interventionId Index of intervention
 * @param taxType Two, Three, Four or Five Dollar Smoking tax intervention
 * @param statinsType Type of statins intervention (Weak, Strong, Stronger or Strongest)
 * @param isEducationPresent True if education intervention is present
 */
-void CardioModel::processChdEvents(int interventionId, int taxType, int statinsType, bool isEducationPresent)
+void CardioModel::processChdEvents(Scenario &scenario, int interventionId, int taxType, int statinsType, bool isEducationPresent)
 {
 	if(!isEducationPresent)
 	{
 		std::string interventionType = parameters->getInterventionType(interventionId, statinsType, taxType, isEducationPresent);
 
-		count->clearCHDdeaths();
+		scenario.count->clearCHDdeaths();
 
-		double deathsPerYear;
 		double totalDeaths = 0;
 
 		int num_years = parameters->getCardioParam()->num_years;
+		int num_raceGender = NHANES::Org::_size()*NHANES::Sex::_size();
 
-		std::cout << std::endl;
-		for(int year = 1; year <= num_years; ++year)
+		std::vector<int> deaths(num_years+1, 0);
+		//statin users by race-gender type and last year alive
+		std::vector<std::vector<int>> statinUsers(num_raceGender, std::vector<int>(num_years+1, 0));
+
+		std::cout << "\nProcessing Fatal CHD events.." << std::endl;
+		for(auto agent : *scenario.agents)
 		{
-			int alive = 0;
+			if(agent->isDead())
+				continue;
+
+			int deathYear = agent->processChdEvent(interventionType, num_years);
+			if(deathYear > 0)
+				deaths[deathYear]++;
+
+			if(agent->isOnStatin())
+			{
+				int lastYearAlive = (deathYear > 0) ? deathYear-1 : num_years;
+				statinUsers[CardioCounter::getTypeCode(agent->getNHANESOrigin(), agent->getSex())][lastYearAlive]++;
+			}
+		}
 
-			std::cout << "Processing Fatal CHD events: Year " << year << std::endl;
-			for(auto agent : agentList)
+		for(auto org : NHANES::Org::_values())
+		{
+			for(auto sex : NHANES::Sex::_values())
 			{
-				if(agent->isDead())
-					continue;
-				
-				agent->processChdEvent(interventionId, statinsType, taxType, year, isEducationPresent);
+				std::string agentType = std::to_string(org) + std::to_string(sex);
+				std::vector<int> &users = statinUsers[CardioCounter::getTypeCode(org, sex)];
 
-				if(!agent->isDead())
-					alive++;
+				int usersAlive = 0;
+				for(int year = num_years; year >= 1; --year)
+				{
+					usersAlive += users[year];
+					scenario.count->addStatinsUsage(agentType, parameters->afterIntervention(year+1), interventionId, 
+						statinsType, taxType, isEducationPresent, usersAlive);
+				}
 			}
+		}
 
-			deathsPerYear = count->getChdDeaths(interventionType, year);
-			totalDeaths += deathsPerYear;
+		int alive = (int)scenario.agents->size();
+		for(int year = 1; year <= num_years; ++year)
+		{
+			alive -= deaths[year];
+			totalDeaths += deaths[year];
 
-			std::cout << "CHD deaths=" << deathsPerYear << "," << "Pop=" << alive << std::endl << std::endl;
+			std::cout << "Year " << year << ": CHD deaths=" << deaths[year] << "," << "Pop=" << alive << std::endl;
 		}
+		std::cout << std::endl;
 
 		std::cout << "Total CHD deaths=" << totalDeaths << std::endl;
 	}
@@ -629,12 +962,13 @@ void CardioModel::processChdEvents(int interventionId, int taxType, int statinsT
 
 /*
 * @brief Executes a method to reset agent's attributes to initial state (original attributes before intervention)
+* @param scenario Agents, counter and random stream of the scenario
 */
-void CardioModel::resetAttributes()
+void CardioModel::resetAttributes(Scenario &scenario)
 {
 	std::cout << "\nResetting agent attributes.." << std::endl;
 	
-	for(auto agent : agentList)
+	for(auto agent : *scenario.agents)
 	{
 		agent->resetAttributes();
 	}
@@ -644,8 +978,9 @@ void CardioModel::resetAttributes()
 
 /*
 * @brief Executes a method to reset a person type (person type by race, gender and education)
+* @param counter Counter of the scenario
 */
-void CardioModel::resetPersonCounter()
+void CardioModel::resetPersonCounter(CardioCounter *counter)
 {
 	std::string agent_type;
 	for(auto org : NHANES::Org::_values())
@@ -655,7 +990,7 @@ void CardioModel::resetPersonCounter()
 			for(auto edu : NHANES::Edu::_values())
 			{
 				agent_type = "edu" + std::to_string(org) + std::to_string(sex) + std::to_string(edu);
-				count->resetPersonCount(agent_type);
+				counter->resetPersonCount(agent_type);
 			}
 		}
 	}
@@ -808,5 +1143,5 @@ void CardioModel::clearList()
 	agentList.clear();
 	agentList.shrink_to_fit();
 
-	agentsPtrMap.clear();
+	population.clear();
 }
\ No newline at end of file
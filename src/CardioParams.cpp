@@ -1,5 +1,30 @@
 #include "CardioParams.h"
 
+#include <algorithm>
+
+namespace
+{
+	typedef std::pair<double, EET::RiskFactors> SumRiskPair;
+
+	bool compareSumRisks(const SumRiskPair &lhs, const SumRiskPair &rhs)
+	{
+		return lhs.first < rhs.first;
+	}
+
+	/*
+	* @brief Sorts risk factors by sum of risks and copies them into the given list
+	*/
+	void addSortedRisks(EET::SortedRisks &sorted, std::vector<SumRiskPair> &candidates)
+	{
+		std::stable_sort(candidates.begin(), candidates.end(), compareSumRisks);
+		for(auto c = candidates.begin(); c != candidates.end(); ++c)
+		{
+			sorted.sumRisks.push_back(c->first);
+			sorted.risks.push_back(c->second);
+		}
+	}
+}
+
 CardioParams::CardioParams() {}
 
 CardioParams::CardioParams(const char *inDir, const char *outDir, const int simModel, const int geoLvl)
@@ -191,6 +216,7 @@ void CardioParams::readNHANESRiskFactors()
 
 	addRiskFactors(m_tempRiskFactors, m_weightByAgentType); 
 	computeRiskFactorSelectionProbability(m_weightByAgentType);
+	computeReplacementRisks();
 	
 }
 
@@ -263,6 +289,90 @@ void CardioParams::computeRiskFactorSelectionProbability( WeightsByAgentType &m_
 	}
 }
 
+/*
+* @brief Builds candidate lists of risk factors for each agent type (race, gender, age cat, 
+*        and education) and risk strata, used to replace risk factors of agents whose smoking 
+*        status changes under smoking tax intervention. Candidates are sorted by sum of total 
+*        cholesterol and systolic BP, so that candidates with lower or higher risk than the 
+*        agent are a prefix or suffix of a list.
+*/
+void CardioParams::computeReplacementRisks()
+{
+	m_replacementRisks.assign(getNumRiskTypes()*NUM_RISK_STRATA, EET::ReplacementRisks());
+
+	std::vector<SumRiskPair> all, former, nonSmoker;
+	for(auto org : NHANES::Org::_values())
+	{
+		for(auto sex : NHANES::Sex::_values())
+		{
+			for(auto age : NHANES::AgeCat::_values())
+			{
+				for(auto edu : NHANES::Edu::_values())
+				{
+					std::string agent_type = std::to_string(org) + std::to_string(sex) + std::to_string(age) + std::to_string(edu);
+					if(m_riskFactors.count(agent_type) == 0)
+						continue;
+
+					for(auto strata = m_riskFactors[agent_type].begin(); strata != m_riskFactors[agent_type].end(); ++strata)
+					{
+						if(strata->first < 1 || strata->first > NUM_RISK_STRATA)
+							continue;
+
+						all.clear();
+						former.clear();
+						nonSmoker.clear();
+
+						for(auto risk_vec = strata->second.begin(); risk_vec != strata->second.end(); ++risk_vec)
+						{
+							const EET::RiskFactors &risks = risk_vec->second;
+							SumRiskPair candidate = std::make_pair(risks.tchols.first + risks.systolicBp.first, risks);
+
+							all.push_back(candidate);
+							if(risks.curSmokeStat == NHANES::SmokingStatus::FormerSmoker)
+								former.push_back(candidate);
+							else if(risks.curSmokeStat == NHANES::SmokingStatus::NonSmoker)
+								nonSmoker.push_back(candidate);
+						}
+
+						int idx = getRiskTypeCode(org, sex, age, edu)*NUM_RISK_STRATA + (strata->first-1);
+
+						EET::ReplacementRisks &table = m_replacementRisks[idx];
+						addSortedRisks(table.all, all);
+						addSortedRisks(table.formerSmoker, former);
+						addSortedRisks(table.nonSmoker, nonSmoker);
+					}
+				}
+			}
+		}
+	}
+}
+
+/*
+* @brief Returns code of agent type (race, gender, age cat, and education) in [0, getNumRiskTypes()), 
+*        or -1 if the agent type doesn't exist
+*/
+int CardioParams::getRiskTypeCode(int org, int sex, int age_cat, int edu) const
+{
+	bool validType = (org >= 1 && org <= (int)NHANES::Org::_size()) && (sex >= 1 && sex <= (int)NHANES::Sex::_size())
+		&& (age_cat >= 1 && age_cat <= (int)NHANES::AgeCat::_size()) && (edu >= 1 && edu <= (int)NHANES::Edu::_size());
+
+	if(validType)
+	{
+		int code = (org-1);
+		code = code*NHANES::Sex::_size() + (sex-1);
+		code = code*NHANES::AgeCat::_size() + (age_cat-1);
+
+		return code*NHANES::Edu::_size() + (edu-1);
+	}
+	else
+		return -1;
+}
+
+int CardioParams::getNumRiskTypes() const
+{
+	return NHANES::Org::_size()*NHANES::Sex::_size()*NHANES::AgeCat::_size()*NHANES::Edu::_size();
+}
+
 /*
 * @brief Reads "risk_matrix.csv" file containing the different combinations of 
 *        risk factors (Total Cholesterol, HDL, Systolic BP, Smoking Status, and Hypertension)
@@ -470,18 +580,18 @@ const CardioParams::AgentStrataRiskMap * CardioParams::getRiskFactorMap()
 
 const CardioParams::VectorWeightRisks * CardioParams::getRiskFactorByStrata(std::string agent_type, int strata)
 {
+	//read-only lookup; agents of concurrent scenarios query the table at the same time
+	static const VectorWeightRisks emptyRisks;
 	if(m_riskFactors.count(agent_type) > 0)
 	{
-		if(m_riskFactors[agent_type].count(strata) > 0)
+		auto it = m_riskFactors[agent_type].find(strata);
+		if(it != m_riskFactors[agent_type].end())
 		{
-			return &m_riskFactors[agent_type][strata];
+			return &it->second;
 		}
 		else
 		{
-			VectorWeightRisks temp;
-			m_riskFactors[agent_type].insert(std::make_pair(strata, temp));
-
-			return &m_riskFactors[agent_type][strata];
+			return &emptyRisks;
 		}
 	}
 	else
@@ -492,6 +602,27 @@ const CardioParams::VectorWeightRisks * CardioParams::getRiskFactorByStrata(std:
 }
 
 
+/*
+* @brief Returns candidate risk factors of an agent type and risk strata after change in smoking status
+* @param org Race of agent
+* @param sex Gender of agent
+* @param age_cat NHANES age category of agent
+* @param edu Education category of agent
+* @param strata Risk strata of agent
+*/
+const EET::ReplacementRisks * CardioParams::getReplacementRisks(int org, int sex, int age_cat, int edu, int strata) const
+{
+	int code = getRiskTypeCode(org, sex, age_cat, edu);
+
+	if(code >= 0 && strata >= 1 && strata <= NUM_RISK_STRATA)
+		return &m_replacementRisks[code*NUM_RISK_STRATA + (strata-1)];
+	else
+	{
+		std::cout <<"Error: Agent type " << org << sex << age_cat << edu << " with risk strata " << strata << " doesn't exist!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+}
+
 const EET::RiskState * CardioParams::getRiskMatrix(int risk_strata)
 {
 	if(m_riskMatrix.count(risk_strata) > 0)
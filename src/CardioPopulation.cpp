@@ -0,0 +1,219 @@
+#include "CardioPopulation.h"
+#include "CardioAgent.h"
+#include "CardioCounter.h"
+#include "ACS.h"
+
+#include <iostream>
+#include <cmath>
+#include <algorithm>
+
+CardioPopulation::CardioPopulation()
+{
+}
+
+CardioPopulation::~CardioPopulation()
+{
+}
+
+/*
+* @brief Sets coefficients, survival rates and mean risk factors (before intervention) of
+*        the CHD risk equations for each race-gender type
+* @param parameters Cardio model parameters
+* @param counter Counter holding mean risk factors
+*/
+void CardioPopulation::setCoefficients(std::shared_ptr<CardioParams> parameters, CardioCounter *counter)
+{
+	const EET::Cardio *cardio = parameters->getCardioParam();
+	std::string timeFrame = parameters->beforeIntervention();
+
+	coefficients.assign(NHANES::Org::_size()*NHANES::Sex::_size(), CHDRiskCoefficients());
+	for(auto org : NHANES::Org::_values())
+	{
+		for(auto sex : NHANES::Sex::_values())
+		{
+			int typeCode = CardioCounter::getTypeCode(org, sex);
+			CHDRiskCoefficients &c = coefficients[typeCode];
+
+			bool male = (sex == (int)NHANES::Sex::Male);
+			bool white = (org == (int)NHANES::Org::WhiteNH);
+
+			c.beta = male ? cardio->male_coeff : cardio->female_coeff;
+			c.scoreBeta = cardio->score_beta_coeff;
+			c.maxAge = male ? 70 : 78;
+
+			if(white)
+			{
+				c.survival = male ? cardio->chd_survival_white_male : cardio->chd_survival_white_female;
+				c.fatalSurvival = male ? cardio->fatal_chd_survival_white_male : cardio->fatal_chd_survival_white_female;
+			}
+			else
+			{
+				c.survival = male ? cardio->chd_survival_black_male : cardio->chd_survival_black_female;
+				c.fatalSurvival = male ? cardio->fatal_chd_survival_black_male : cardio->fatal_chd_survival_black_female;
+			}
+
+			c.meanSum = counter->getMeanWeightedSum(timeFrame, typeCode);
+			c.meanTchols = counter->getMeanRiskFactor(timeFrame, typeCode, NHANES::RiskFac::totalChols);
+			c.meanSbp = counter->getMeanRiskFactor(timeFrame, typeCode, NHANES::RiskFac::SystolicBp);
+		}
+	}
+}
+
+/*
+* @brief Copies risk factors used by the CHD risk equations from agents into contiguous arrays.
+*        Must be called after setCoefficients (age is capped at the maximum age of the type).
+* @param agents List of agents
+* @param compress If true, agents with identical inputs of the risk equations share one slot
+* @param changedOnly If true, only agents whose risk inputs changed get a slot; others keep their baseline risk
+*/
+void CardioPopulation::gather(const AgentList *agents, bool compress, bool changedOnly)
+{
+	size_t num_agents = agents->size();
+
+	clear();
+	profile.resize(num_agents);
+	for(size_t i = 0; i < num_agents; ++i)
+	{
+		const CardioAgent *agent = agents->at(i);
+		const EET::RiskFactors *chart = agent->getRiskFactors();
+
+		if(changedOnly && !agent->isRiskChanged())
+		{
+			baseTotalCHD.push_back(agent->getBaselineTotalCHDRisk());
+			baseFatalCHD.push_back(agent->getBaselineFatalCHDRisk());
+			profile[i] = -(int)baseTotalCHD.size();
+			continue;
+		}
+
+		int code = CardioCounter::getTypeCode(agent->getNHANESOrigin(), agent->getSex());
+		double agentAge = std::min(agent->getRiskFactor(NHANES::RiskFac::Age), coefficients[code].maxAge);
+
+		ProfileKey key(code, agentAge, chart->tchols.first, chart->hdlChols.first, 
+			chart->systolicBp.first, chart->htnMed, chart->curSmokeStat);
+
+		if(compress)
+		{
+			auto it = profileIdx.find(key);
+			if(it != profileIdx.end())
+			{
+				profile[i] = it->second;
+				continue;
+			}
+			profileIdx.insert(std::make_pair(key, (int)typeCode.size()));
+		}
+
+		profile[i] = (int)typeCode.size();
+		typeCode.push_back(code);
+		age.push_back(agentAge);
+		tchols.push_back(std::get<2>(key));
+		hdl.push_back(std::get<3>(key));
+		sbp.push_back(std::get<4>(key));
+		htnMed.push_back(std::get<5>(key));
+		smokeStat.push_back(std::get<6>(key));
+	}
+
+	pTotalCHD.assign(typeCode.size(), 0);
+	pFatalCHD.assign(typeCode.size(), 0);
+
+	if(compress || changedOnly)
+		std::cout << "CHD risk evaluated for " << typeCode.size() << " risk profiles of " << num_agents << " agents" << std::endl;
+}
+
+/*
+* @brief Computes 10-year total (Framingham) and fatal (SCORE) CHD risk of slots in [first, last)
+*/
+void CardioPopulation::computeCHDRisk(size_t first, size_t last)
+{
+	computeTotalCHDRisk(first, last);
+	computeFatalCHDRisk(first, last);
+}
+
+void CardioPopulation::computeTotalCHDRisk(size_t first, size_t last)
+{
+	for(size_t i = first; i < last; ++i)
+	{
+		const CHDRiskCoefficients &c = coefficients[typeCode[i]];
+		const EET::Framingham &b = c.beta;
+
+		double logAge = log(age[i]);
+		double logTchols = log(tchols[i]);
+
+		double sum = b.age*logAge + b.tchols*logTchols + b.hdl*log(hdl[i])
+			+ b.sbp*log(sbp[i]) + b.htn*htnMed[i] + b.smoker*smokeStat[i]
+			+ b.age_tchols*logAge*logTchols + b.age_smoker*logAge*smokeStat[i]
+			+ b.sq_age*logAge*logAge;
+
+		pTotalCHD[i] = 1 - pow(c.survival, exp(sum - c.meanSum));
+	}
+}
+
+void CardioPopulation::computeFatalCHDRisk(size_t first, size_t last)
+{
+	const double chols_conversion = 0.02586;
+	for(size_t i = first; i < last; ++i)
+	{
+		const CHDRiskCoefficients &c = coefficients[typeCode[i]];
+		const EET::Score &beta = c.scoreBeta;
+
+		double sum = beta.tchols*(chols_conversion*(tchols[i]-c.meanTchols))
+			+ beta.sbp*(sbp[i]-c.meanSbp) + beta.smoking*smokeStat[i];
+
+		pFatalCHD[i] = 1 - pow(c.fatalSurvival, exp(sum));
+	}
+}
+
+void CardioPopulation::clear()
+{
+	profile.clear();
+	profileIdx.clear();
+	baseTotalCHD.clear();
+	baseFatalCHD.clear();
+
+	typeCode.clear();
+	age.clear();
+	tchols.clear();
+	hdl.clear();
+	sbp.clear();
+	htnMed.clear();
+	smokeStat.clear();
+
+	pTotalCHD.clear();
+	pFatalCHD.clear();
+}
+
+/*
+* @brief Returns number of slots for which risk is evaluated
+*/
+size_t CardioPopulation::size() const
+{
+	return typeCode.size();
+}
+
+size_t CardioPopulation::getNumAgents() const
+{
+	return profile.size();
+}
+
+/*
+* @brief Returns 10-year total CHD risk of an agent
+* @param i Index of agent in the gathered list
+*/
+double CardioPopulation::getTotalCHDRisk(size_t i) const
+{
+	if(profile[i] >= 0)
+		return pTotalCHD[profile[i]];
+	else
+		return baseTotalCHD[-profile[i]-1];
+}
+
+/*
+* @brief Returns 10-year fatal CHD risk of an agent
+* @param i Index of agent in the gathered list
+*/
+double CardioPopulation::getFatalCHDRisk(size_t i) const
+{
+	if(profile[i] >= 0)
+		return pFatalCHD[profile[i]];
+	else
+		return baseFatalCHD[-profile[i]-1];
+}
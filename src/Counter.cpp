@@ -10,7 +10,7 @@ template class Counter<CardioParams>;
 template class Counter<DepressionParams>;
 
 template<class GenericParams>
-Counter<GenericParams>::Counter()
+Counter<GenericParams>::Counter() : m_numFixedTypes(0)
 {
 }
 
@@ -20,10 +20,11 @@ Counter<GenericParams>::~Counter()
 }
 
 template<class GenericParams>
-int Counter<GenericParams>::getHouseholdCount(std::string hhType) const
+int Counter<GenericParams>::getHouseholdCount(const std::string &hhType) const
 {
-	if(m_householdCount.count(hhType) > 0)
-		return m_householdCount.at(hhType).size();
+	auto idx = m_householdIdx.find(hhType);
+	if(idx != m_householdIdx.end())
+		return m_householdCount[idx->second];
 	else
 	{
 		std::cout << "Error: Household type " << hhType << " doesn't exist!" << std::endl;
@@ -32,10 +33,11 @@ int Counter<GenericParams>::getHouseholdCount(std::string hhType) const
 }
 
 template<class GenericParams>
-int Counter<GenericParams>::getPersonCount(std::string personType) const
+int Counter<GenericParams>::getPersonCount(const std::string &personType) const
 {
-	if(m_personCount.count(personType) > 0)
-		return m_personCount.at(personType).size();
+	auto idx = m_personIdx.find(personType);
+	if(idx != m_personIdx.end())
+		return m_personCount[idx->second];
 	else
 	{
 		return 0;
@@ -44,6 +46,32 @@ int Counter<GenericParams>::getPersonCount(std::string personType) const
 	}
 }
 
+/*
+* @brief Returns code (index) of person type, or -1 if person type is not counted yet
+*/
+template<class GenericParams>
+int Counter<GenericParams>::getPersonTypeCode(const std::string &personType) const
+{
+	auto idx = m_personIdx.find(personType);
+	return (idx != m_personIdx.end()) ? idx->second : -1;
+}
+
+/*
+* @brief Returns code (index) of household type, or -1 if household type doesn't exist
+*/
+template<class GenericParams>
+int Counter<GenericParams>::getHouseholdTypeCode(const std::string &hhType) const
+{
+	auto idx = m_householdIdx.find(hhType);
+	return (idx != m_householdIdx.end()) ? idx->second : -1;
+}
+
+template<class GenericParams>
+bool Counter<GenericParams>::hasPersonType(const std::string &personType) const
+{
+	return m_personIdx.count(personType) > 0;
+}
+
 template<class GenericParams>
 void Counter<GenericParams>::initialize()
 {
@@ -63,40 +91,155 @@ void Counter<GenericParams>::initialize()
 	//}
 }
 
+/*
+* @brief Initializes household and person counters with household and person pools.
+*        Used for thread-local counters.
+*/
+template<class GenericParams>
+void Counter<GenericParams>::initCounter(std::shared_ptr<GenericParams> p)
+{
+	initHouseholdCounter(p);
+	initPersonCounter(p);
+}
+
+/*
+* @brief Initializes a thread-local counter (shard) with the household and person type 
+*        codes of master and empty counts
+* @param master Counter the shard will be merged into
+*/
+template<class GenericParams>
+void Counter<GenericParams>::initShard(const Counter<GenericParams> &master)
+{
+	m_householdIdx = master.m_householdIdx;
+	m_personIdx = master.m_personIdx;
+	m_personTypes = master.m_personTypes;
+	m_numFixedTypes = master.m_numFixedTypes;
+
+	m_householdCount.assign(master.m_householdCount.size(), 0);
+	m_personCount.assign(master.m_personCount.size(), 0);
+}
+
+/*
+* @brief Adds household and person counts of another counter (e.g. a thread-local counter).
+*        Both counters share codes of the household pool and of the person types registered 
+*        at initPersonCounter, which are added by code; person types counted later are added by name.
+*/
+template<class GenericParams>
+void Counter<GenericParams>::merge(const Counter<GenericParams> &other)
+{
+	size_t num_households = std::min(m_householdCount.size(), other.m_householdCount.size());
+	for(size_t hh = 0; hh < num_households; ++hh)
+		m_householdCount[hh] += other.m_householdCount[hh];
+
+	size_t num_fixed = std::min(m_numFixedTypes, other.m_numFixedTypes);
+	for(size_t pp = 0; pp < num_fixed; ++pp)
+		m_personCount[pp] += other.m_personCount[pp];
+
+	for(size_t pp = num_fixed; pp < other.m_personCount.size(); ++pp)
+	{
+		int code = registerPersonType(other.m_personTypes[pp]);
+		m_personCount[code] += other.m_personCount[pp];
+	}
+}
 
 template<class GenericParams>
 void Counter<GenericParams>::initHouseholdCounter(std::shared_ptr<GenericParams> p)
 {
-	clearMap(m_householdCount);
+	m_householdIdx.clear();
+	m_householdCount.clear();
 
-	std::vector<bool> hhCounts;
-	hhCounts.reserve(0);
-	
 	const Pool *householdsPool = p->getHouseholdPool();
 
 	for(size_t hh = 0; hh < householdsPool->size(); ++hh)
-		m_householdCount.insert(std::make_pair(householdsPool->at(hh), hhCounts));
+		m_householdIdx.insert(std::make_pair(householdsPool->at(hh), (int)hh));
 
+	m_householdCount.assign(householdsPool->size(), 0);
 }
 
 template<class GenericParams>
 void Counter<GenericParams>::initPersonCounter(std::shared_ptr<GenericParams> p)
 {
-	clearMap(m_personCount);
-
-	std::vector<bool> personCounts;
-	personCounts.reserve(0);
+	m_personIdx.clear();
+	m_personCount.clear();
+	m_personTypes.clear();
 	
 	const Pool *indivPool = p->getPersonPool();
 	for(size_t pp = 0; pp < indivPool->size(); ++pp)
-		m_personCount.insert(std::make_pair(indivPool->at(pp), personCounts));
+		registerPersonType(indivPool->at(pp));
+
+	registerAgentTypes();
+	m_numFixedTypes = m_personCount.size();
+}
+
+/*
+* @brief Registers person types counted by agents of the model, so that agents can be
+*        counted by code. Called by initPersonCounter after the person pool is registered.
+*/
+template<class GenericParams>
+void Counter<GenericParams>::registerAgentTypes()
+{
+}
+
+/*
+* @brief Returns code of person type, adding the person type to the counter if it is new
+*/
+template<class GenericParams>
+int Counter<GenericParams>::registerPersonType(const std::string &personType)
+{
+	auto idx = m_personIdx.find(personType);
+	if(idx != m_personIdx.end())
+		return idx->second;
+
+	int code = m_personCount.size();
+	m_personIdx.insert(std::make_pair(personType, code));
+	m_personCount.push_back(0);
+	m_personTypes.push_back(personType);
+
+	return code;
+}
+
+/*
+* @brief Returns code from a table of person type codes stored by row and column (see 
+*        registerAgentTypes), or -1 if row or column is out of range
+* @param codes Table of person type codes
+* @param row Row index
+* @param col Column index
+* @param num_cols Number of columns of table
+*/
+template<class GenericParams>
+int Counter<GenericParams>::getTableCode(const std::vector<int> &codes, int row, int col, int num_cols) const
+{
+	if(row < 0 || col < 0 || col >= num_cols || (size_t)(row*num_cols + col) >= codes.size())
+		return -1;
+
+	return codes[row*num_cols + col];
 }
 
 template<class GenericParams>
-void Counter<GenericParams>::addHouseholdCount(std::string hhType)
+void Counter<GenericParams>::addHouseholdCount(const std::string &hhType)
 {
-	if (m_householdCount.count(hhType) > 0)
-		m_householdCount[hhType].push_back(true);
+	int code = getHouseholdTypeCode(hhType);
+	if(code >= 0)
+		m_householdCount[code]++;
+}
+
+template<class GenericParams>
+void Counter<GenericParams>::addHouseholdTypeCount(int code)
+{
+	m_householdCount[code]++;
+}
+
+template<class GenericParams>
+void Counter<GenericParams>::addPersonTypeCount(int code)
+{
+	m_personCount[code]++;
+}
+
+template<class GenericParams>
+void Counter<GenericParams>::removePersonTypeCount(int code)
+{
+	if(m_personCount[code] > 0)
+		m_personCount[code]--;
 }
 
 template<class GenericParams>
@@ -107,58 +250,29 @@ void Counter<GenericParams>::addPersonCount(const char* personType)
 }
 
 template<class GenericParams>
-void Counter<GenericParams>::addPersonCount(std::string personType)
+void Counter<GenericParams>::addPersonCount(const std::string &personType)
 {
-	if(m_personCount.count(personType) > 0)
-		m_personCount[personType].push_back(true);
-	else
-	{
-		std::vector<bool>temp;
-		temp.push_back(true);
-
-		m_personCount.insert(std::make_pair(personType, temp));
-	}
+	m_personCount[registerPersonType(personType)]++;
 }
 
 template<class GenericParams>
 void Counter<GenericParams>::addPersonCount(int origin, int sex)
 {
-	std::string agentType = std::to_string(origin)+std::to_string(sex);
-	if(m_personCount.count(agentType) == 0)
-	{
-		std::vector<bool>count;
-		count.push_back(true);
-
-		m_personCount.insert(std::make_pair(agentType, count));
-	}
-	else
-	{
-		m_personCount[agentType].push_back(true);
-	}
+	addPersonCount(std::to_string(origin)+std::to_string(sex));
 }
 
 template<class GenericParams>
 void Counter<GenericParams>::addPersonCount(std::string personType, std::string ptsdx_quartile)
 {
-	std::string agentType = personType + ptsdx_quartile;
-	if(m_personCount.count(agentType) == 0)
-	{
-		std::vector<bool>count;
-		count.push_back(true);
-
-		m_personCount.insert(std::make_pair(agentType, count));
-	}
-	else
-	{
-		m_personCount[agentType].push_back(true);
-	}
+	addPersonCount(personType + ptsdx_quartile);
 }
 
 template<class GenericParams>
 void Counter<GenericParams>::resetPersonCount(std::string personType)
 {
-	if(m_personCount.count(personType) > 0)
-		m_personCount[personType].clear();
+	int code = getPersonTypeCode(personType);
+	if(code >= 0)
+		m_personCount[code] = 0;
 }
 
 
@@ -189,8 +303,8 @@ void Counter<GenericParams>::outputHouseholdCounts(std::shared_ptr<GenericParams
 			{
 				std::string var_type = std::to_string(hhType)+std::to_string(hhSize)+std::to_string(hhInc);
 				//countHHSize += m_householdCount.count(var_type);
-				if(m_householdCount.count(var_type) > 0)
-					countHHSize += m_householdCount[var_type].size();
+				if(m_householdIdx.count(var_type) > 0)
+					countHHSize += getHouseholdCount(var_type);
 			}
 			hhFile << countHHSize << ",";
 		}
@@ -214,8 +328,8 @@ void Counter<GenericParams>::outputHouseholdCounts(std::shared_ptr<GenericParams
 			{
 				std::string var_type = std::to_string(hhType)+std::to_string(hhSize)+std::to_string(hhInc);
 				//countHHInc += m_householdCount.count(var_type);
-				if(m_householdCount.count(var_type) > 0)
-					countHHInc += m_householdCount[var_type].size();
+				if(m_householdIdx.count(var_type) > 0)
+					countHHInc += getHouseholdCount(var_type);
 			}
 			hhFile << countHHInc << ",";
 		}
@@ -255,8 +369,7 @@ void Counter<GenericParams>::outputPersonCounts(std::shared_ptr<GenericParams> p
 			{
 				std::string type = dummy+std::to_string(sex)+std::to_string(ageCat)+std::to_string(org);
 				//countAge += m_personCount.count(type);
-				if(m_personCount.count(type) > 0)
-					countAge += m_personCount[type].size();
+				countAge += getPersonCount(type);
 			}
 			pFile << countAge << ",";
 		}
@@ -279,8 +392,7 @@ void Counter<GenericParams>::outputPersonCounts(std::shared_ptr<GenericParams> p
 			{
 				std::string type = dummy+std::to_string(sex)+std::to_string(ageCat)+std::to_string(org);
 				//countOrigin += m_personCount.count(type);
-				if(m_personCount.count(type) > 0)
-					countOrigin += m_personCount[type].size();
+				countOrigin += getPersonCount(type);
 			}
 			pFile << countOrigin << ",";
 		}
@@ -306,8 +418,7 @@ void Counter<GenericParams>::outputPersonCounts(std::shared_ptr<GenericParams> p
 				for(auto org : ACS::Origin::_values())
 				{
 					std::string type = std::to_string(sex)+std::to_string(eduAge)+std::to_string(org)+std::to_string(edu);
-					if(m_personCount.count(type) > 0)
-						countEdu += m_personCount[type].size();
+					countEdu += getPersonCount(type);
 				}
 				pFile << countEdu << ",";
 			}
@@ -59,7 +59,7 @@ void DepressionAgent::reduceWageGap()
 			}
 		}
 
-		counter->addPersonCount(getAgentType1());
+		counter->addIncomePovertyCount(sex, ageCat, ipRatioTag);
 	}
 
 }
@@ -121,7 +121,7 @@ void DepressionAgent::setDepressionType(short int depression_type)
 
 void DepressionAgent::setDepressionSymptoms()
 {
-	counter->addPersonCount(getAgentType2());
+	counter->addDepressionTypeCount(depressionType, sex, ageCat, ipRatioTag);
 	//counter->addPersonCount(getAgentType5());
 	
 	const Tuple *depression_symptoms = parameters->getDepressionSymptoms(getAgentType2());
@@ -130,22 +130,22 @@ void DepressionAgent::setDepressionSymptoms()
 	if(randP < Depression::first_q)
 	{
 		this->symptoms = std::get<0>(*depression_symptoms);
-		counter->addPersonCount(getAgentType2(), "1Q");
+		counter->addSymptomsQuartileCount(depressionType, sex, ageCat, ipRatioTag, 1);
 	}
 	else if(randP < Depression::second_q)
 	{
 		this->symptoms = std::get<1>(*depression_symptoms);
-		counter->addPersonCount(getAgentType2(), "2Q");
+		counter->addSymptomsQuartileCount(depressionType, sex, ageCat, ipRatioTag, 2);
 	}
 	else if(randP < Depression::third_q)
 	{
 		this->symptoms = std::get<2>(*depression_symptoms);
-		counter->addPersonCount(getAgentType2(), "3Q");
+		counter->addSymptomsQuartileCount(depressionType, sex, ageCat, ipRatioTag, 3);
 	}
 	else if(randP < Depression::fourth_q)
 	{
 		this->symptoms = std::get<3>(*depression_symptoms);
-		counter->addPersonCount(getAgentType2(), "4Q");
+		counter->addSymptomsQuartileCount(depressionType, sex, ageCat, ipRatioTag, 4);
 	}
 
 }
@@ -160,6 +160,11 @@ short int DepressionAgent::getDepressionType() const
 	return depressionType;
 }
 
+short int DepressionAgent::getIncomePovertyRatioTag() const
+{
+	return ipRatioTag;
+}
+
 /**
 *	@brief returns agentType by sex, age cat and income to poverty ratio category
 *	@param none
@@ -210,6 +215,16 @@ std::string DepressionAgent::getAgentType5() const
 	return "Depression_Type_" + getAgentType4() + std::to_string(depressionType);
 }
 
+void DepressionAgent::setCounter(DepressionCounter *count)
+{
+	this->counter = count;
+}
+
+void DepressionAgent::setRandom(Random *rand)
+{
+	this->random = rand;
+}
+
 DepressionCounter *DepressionAgent::getCounter()
 {
 	return counter;
@@ -1,5 +1,6 @@
 #include "DepressionCounter.h"
 #include "DepressionParams.h"
+#include "DepressionAgent.h"
 
 DepressionCounter::DepressionCounter()
 {
@@ -19,6 +20,143 @@ void DepressionCounter::initialize()
 	initPersonCounter(param);
 }
 
+/*
+* @brief Initializes a thread-local counter (shard) with person type codes and empty counters
+* @param master Counter the shard will be merged into
+*/
+void DepressionCounter::initShard(const DepressionCounter &master)
+{
+	param = master.param;
+	initPersonCounter(param);
+}
+
+/*
+* @brief Registers agent types counted by agents: sex-age cat, income to poverty ratio, depression 
+*        type and depression symptoms quartile types, stored by sex and age cat
+*/
+void DepressionCounter::registerAgentTypes()
+{
+	m_sexAgeCatCodes.clear();
+	m_ipRatioCodes.clear();
+	m_depressionTypeCodes.clear();
+	m_symptomsCodes.clear();
+
+	for(auto sex : ACS::Sex::_values())
+	{
+		for(auto ageCat : Depression::AgeCat::_values())
+		{
+			std::string sexAgeCat = std::to_string(sex) + std::to_string(ageCat);
+			m_sexAgeCatCodes.push_back(registerPersonType("Sex_Age_Cat" + sexAgeCat));
+
+			for(auto ipRatio : ACS::IncomeToPovertyRatio::_values())
+				m_ipRatioCodes.push_back(registerPersonType("IP_Ratio" + sexAgeCat + std::to_string(ipRatio)));
+
+			for(auto depType : Depression::DepressionType::_values())
+			{
+				for(auto ipRatio : ACS::IncomeToPovertyRatio::_values())
+				{
+					std::string agentType = "Type" + std::to_string(depType) + "IP_Ratio" + sexAgeCat + std::to_string(ipRatio);
+					m_depressionTypeCodes.push_back(registerPersonType(agentType));
+
+					for(int q = 1; q <= Depression::num_quartiles; ++q)
+						m_symptomsCodes.push_back(registerPersonType(agentType + std::to_string(q) + "Q"));
+				}
+			}
+		}
+	}
+}
+
+/*
+* @brief Returns row of sex and age cat in tables of person type codes, or -1 if out of range
+*/
+int DepressionCounter::getSexAgeCatRow(int sex, int ageCat) const
+{
+	if(sex < 1 || sex > (int)ACS::Sex::_size() || ageCat < 1 || ageCat > (int)Depression::AgeCat::_size())
+		return -1;
+
+	return (sex-1)*Depression::AgeCat::_size() + (ageCat-1);
+}
+
+/*
+* @brief Counts agent by sex and age cat
+*/
+void DepressionCounter::addSexAgeCatCount(int sex, int ageCat)
+{
+	int code = getTableCode(m_sexAgeCatCodes, getSexAgeCatRow(sex, ageCat), 0, 1);
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("Sex_Age_Cat" + std::to_string(sex) + std::to_string(ageCat));
+}
+
+/*
+* @brief Counts agent by sex, age cat and income to poverty ratio
+*/
+void DepressionCounter::addIncomePovertyCount(int sex, int ageCat, int ipRatio)
+{
+	int num_ip_ratio = ACS::IncomeToPovertyRatio::_size();
+	int code = getTableCode(m_ipRatioCodes, getSexAgeCatRow(sex, ageCat), ipRatio-1, num_ip_ratio);
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("IP_Ratio" + std::to_string(sex) + std::to_string(ageCat) + std::to_string(ipRatio));
+}
+
+/*
+* @brief Counts agent by depression type, sex, age cat and income to poverty ratio
+*/
+void DepressionCounter::addDepressionTypeCount(int depType, int sex, int ageCat, int ipRatio)
+{
+	int num_ip_ratio = ACS::IncomeToPovertyRatio::_size();
+	int code = -1;
+	if(ipRatio >= 1 && ipRatio <= num_ip_ratio)
+		code = getTableCode(m_depressionTypeCodes, getSexAgeCatRow(sex, ageCat), (depType-1)*num_ip_ratio + (ipRatio-1), 
+			Depression::DepressionType::_size()*num_ip_ratio);
+
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("Type" + std::to_string(depType) + "IP_Ratio" + std::to_string(sex) + std::to_string(ageCat) 
+			+ std::to_string(ipRatio));
+}
+
+/*
+* @brief Counts agent by depression type, sex, age cat, income to poverty ratio and symptoms quartile
+* @param quartile Depression symptoms quartile (1 to 4)
+*/
+void DepressionCounter::addSymptomsQuartileCount(int depType, int sex, int ageCat, int ipRatio, int quartile)
+{
+	int num_ip_ratio = ACS::IncomeToPovertyRatio::_size();
+	int code = -1;
+	if(ipRatio >= 1 && ipRatio <= num_ip_ratio && quartile >= 1 && quartile <= Depression::num_quartiles)
+		code = getTableCode(m_symptomsCodes, getSexAgeCatRow(sex, ageCat), 
+			((depType-1)*num_ip_ratio + (ipRatio-1))*Depression::num_quartiles + (quartile-1), 
+			Depression::DepressionType::_size()*num_ip_ratio*Depression::num_quartiles);
+
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("Type" + std::to_string(depType) + "IP_Ratio" + std::to_string(sex) + std::to_string(ageCat) 
+			+ std::to_string(ipRatio) + std::to_string(quartile) + "Q");
+}
+
+/*
+* @brief Adds counts accumulated by a thread-local counter (shard)
+* @param shard Thread-local counter
+*/
+void DepressionCounter::merge(const DepressionCounter &shard)
+{
+	Counter<DepressionParams>::merge(shard);
+
+	for(auto time = shard.m_depressionPrevalence.begin(); time != shard.m_depressionPrevalence.end(); ++time)
+		for(auto type = time->second.begin(); type != time->second.end(); ++type)
+			m_depressionPrevalence[time->first][type->first] += type->second;
+
+	for(auto time = shard.m_popBySexAgeDepression.begin(); time != shard.m_popBySexAgeDepression.end(); ++time)
+		for(auto type = time->second.begin(); type != time->second.end(); ++type)
+			m_popBySexAgeDepression[time->first][type->first] += type->second;
+}
+
 void DepressionCounter::computeOutcomes(std::string timeFrame)
 {
 	computePrevalence(timeFrame);
@@ -35,7 +35,7 @@ void DepressionHousehold::addMemebers(DepressionAgent *agent)
 		members.push_back(member);
 		if(agent->getAge() >= 18 && this->hhType == ACS::HHType::NonFamily)
 		{
-			agent->getCounter()->addPersonCount(agent->getAgentType4());
+			agent->getCounter()->addSexAgeCatCount(agent->getSex(), agent->getAgeCat());
 		}
 	}
 	else
@@ -69,7 +69,7 @@ void DepressionHousehold::setIncomeToPovertyNonFamily()
 		if(agent->getAge() >= 18)
 		{
 			//agent->getCounter()->addPersonCount(agent->getAgentType3());
-			agent->getCounter()->addPersonCount(agent->getAgentType1());
+			agent->getCounter()->addIncomePovertyCount(agent->getSex(), agent->getAgeCat(), agent->getIncomePovertyRatioTag());
 		}
 	}
 }
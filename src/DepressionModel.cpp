@@ -7,6 +7,7 @@
 #include "DepressionHousehold.h"
 #include "Random.h"
 #include "ElapsedTime.h"
+#include "ParallelBlocks.h"
 
 DepressionModel::DepressionModel()
 {
@@ -57,13 +58,12 @@ void DepressionModel::start(int stateID)
 
 void DepressionModel::addHousehold(const HouseholdPums<DepressionParams> *hh, int countHH)
 {
-	std::vector<PersonPums<DepressionParams>> tempPersons;
 	int countPersons;
 	
 	if(hh->getHouseholdType() >= ACS::HHType::MaleHHFam)
 	{
 		DepressionHousehold *household = new DepressionHousehold(hh);
-		tempPersons = hh->getPersons();
+		const std::vector<PersonPums<DepressionParams>> &tempPersons = hh->getPersonList();
 
 		countPersons = 0;
 		for(auto pp = tempPersons.begin(); pp != tempPersons.end(); ++pp)
@@ -154,9 +154,17 @@ void DepressionModel::computeWageGap()
 
 }
 
+/*
+* @brief Assigns depression type and symptoms to agents of each person type and redraws
+*        until the assigned types fit the prevalence. With more than one thread, agents of
+*        a person type are split into contiguous blocks (see runBlocks) before the fit is checked.
+* @param agents Agents by person type
+* @param timeFrame Before or after intervention
+*/
 void DepressionModel::setDepressionType(AgentMap *agents, std::string timeFrame)
 {
 	std::string quartiles [] = {"1Q", "2Q", "3Q", "4Q"};
+	int num_threads = parameters->getNumThreads();
 
 	for(auto map = agents->begin(); map != agents->end(); ++map)
 	{
@@ -172,16 +180,29 @@ void DepressionModel::setDepressionType(AgentMap *agents, std::string timeFrame)
 			resetPersonCount(quartiles, agent_type);
 
 			std::cout << "\nAttempt: " << ++num_draws << " Pop: " << map->second.size() << std::endl;
-			for(auto agent : map->second)
+			if(num_threads > 1)
 			{
-				double randP = random->uniform_real_dist();
-				for(auto prevalence = depression_preval_pair->begin(); prevalence != depression_preval_pair->end(); ++prevalence)
+				const std::vector<DepressionAgent *> *agents = &map->second;
+				size_t blockSize = (agents->size() + num_threads - 1)/num_threads;
+				runBlocks<DepressionCounter>(num_threads, random, count, 
+					[&](int t, unsigned int seed, DepressionCounter *shard) {
+						size_t first = std::min(agents->size(), t*blockSize);
+						setDepressionTypeBlock(agents, depression_preval_pair, first, std::min(agents->size(), first + blockSize), seed, shard);
+					});
+			}
+			else
+			{
+				for(auto agent : map->second)
 				{
-					double depression_prevalence = prevalence->first;
-					if(randP < depression_prevalence)
+					double randP = random->uniform_real_dist();
+					for(auto prevalence = depression_preval_pair->begin(); prevalence != depression_preval_pair->end(); ++prevalence)
 					{
-						agent->setDepressionType(prevalence->second);
-						break;
+						double depression_prevalence = prevalence->first;
+						if(randP < depression_prevalence)
+						{
+							agent->setDepressionType(prevalence->second);
+							break;
+						}
 					}
 				}
 			}
@@ -193,6 +214,40 @@ void DepressionModel::setDepressionType(AgentMap *agents, std::string timeFrame)
 	count->computeOutcomes(timeFrame);
 }
 
+/*
+* @brief Draws depression type of agents in [first, last)
+* @param agents Agents of a person type
+* @param depression_preval_pair Cumulative prevalence of depression types
+* @param first Index of first agent of the block
+* @param last Index past the last agent of the block
+* @param seed Seed of random stream of the worker
+* @param shard Thread-local counter
+*/
+void DepressionModel::setDepressionTypeBlock(const std::vector<DepressionAgent *> *agents, const VecPairDblInt *depression_preval_pair, 
+	size_t first, size_t last, unsigned int seed, DepressionCounter *shard)
+{
+	Random rand(seed);
+	for(size_t i = first; i < last; ++i)
+	{
+		DepressionAgent *agent = agents->at(i);
+		agent->setCounter(shard);
+		agent->setRandom(&rand);
+
+		double randP = rand.uniform_real_dist();
+		for(auto prevalence = depression_preval_pair->begin(); prevalence != depression_preval_pair->end(); ++prevalence)
+		{
+			if(randP < prevalence->first)
+			{
+				agent->setDepressionType(prevalence->second);
+				break;
+			}
+		}
+
+		agent->setCounter(count);
+		agent->setRandom(random);
+	}
+}
+
 void DepressionModel::execute(std::string state_name)
 {
 	std::cout << "\nReducing Wage-Gender Gap...\n" << std::endl;
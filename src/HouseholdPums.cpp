@@ -179,11 +179,66 @@ std::vector<PersonPums<GenericParams>> HouseholdPums<GenericParams>::getPersons(
 	return hhPersons;
 }
 
+/*
+* @brief Returns persons of household without copying them
+*/
+template<class GenericParams>
+const std::vector<PersonPums<GenericParams>> &HouseholdPums<GenericParams>::getPersonList() const
+{
+	return hhPersons;
+}
+
+/*
+* @brief Returns person type codes (indices into the person pool) of household members, see setPersonTypes
+*/
+template<class GenericParams>
+const std::vector<int> &HouseholdPums<GenericParams>::getPersonTypes() const
+{
+	return personTypeCodes;
+}
+
+/*
+* @brief Precomputes person type codes of household members used for counting drawn persons:
+*        "0"+sex+ageCat+origin for every person and sex+eduAgeCat+origin+education 
+*        for adults (18 and over), resolved once against the person pool.
+* @param poolIdx Index of each person type in the person pool (which equals its counter code)
+*/
+template<class GenericParams>
+void HouseholdPums<GenericParams>::setPersonTypes(const std::map<std::string, int> &poolIdx)
+{
+	std::string sex, ageCat, origin, eduAgeCat, edu;
+	std::string dummy = "0";
+
+	personTypeCodes.clear();
+	for(auto pp = hhPersons.begin(); pp != hhPersons.end(); ++pp)
+	{
+		sex = std::to_string(pp->getSex());
+		origin = std::to_string(pp->getOrigin());
+		ageCat = std::to_string(pp->getAgeCat());
+
+		auto it = poolIdx.find(dummy+sex+ageCat+origin);
+		if(it != poolIdx.end())
+			personTypeCodes.push_back(it->second);
+
+		if(pp->getAge() >= 18)
+		{
+			eduAgeCat = std::to_string(pp->getEduAgeCat());
+			edu = std::to_string(pp->getEducation());
+
+			it = poolIdx.find(sex+eduAgeCat+origin+edu);
+			if(it != poolIdx.end())
+				personTypeCodes.push_back(it->second);
+		}
+	}
+}
+
 template<class GenericParams>
 void HouseholdPums<GenericParams>::clearPersonList()
 {
 	hhPersons.clear();
 	hhPersons.shrink_to_fit();
+	personTypeCodes.clear();
+	personTypeCodes.shrink_to_fit();
 }
 
 
@@ -4,7 +4,8 @@
 #include "CardioParams.h"
 #include "DepressionParams.h"
 
-#define MAX_ITERATIONS 4000
+#define MAX_LINE_SEARCH 10
+#define PRINT_WAIT_TIME 2000 //2 seconds between progress lines
 
 template class IPU<ViolenceParams>;
 template class IPU<CardioParams>;
@@ -12,7 +13,8 @@ template class IPU<DepressionParams>;
 
 template<class GenericParams>
 IPU<GenericParams>::IPU(HouseholdsMap *m_hhPUMS, const std::vector<double>& ipuCons, bool print) : 
-	m_households(m_hhPUMS), cons(ipuCons), eps(1e-3), printOutput(print), ipu_success(false)
+	m_households(m_hhPUMS), cons(ipuCons), eps(1e-3), maxIterations(4000), printOutput(print), ipu_success(false), 
+	corner_solution(false), exportProbabilities(false), integerize(false), solverType(IPU_UPDATING)
 {
 }
 
@@ -26,24 +28,149 @@ template<class GenericParams>
 void IPU<GenericParams>::start()
 {
 	initialize();
-	solve(freqMatrix.n_rows, freqMatrix.n_cols);
-	computeProbabilities();
+	openTrace();
+
+	if(corner_solution)
+		truncateConstraints();
+
+	if(solverType == IPU_RAKING)
+		solveRaking(freqMatrix.n_rows, cons.size());
+	else
+		solve(freqMatrix.n_rows, cons.size());
+
+	saveWeights();
+	closeTrace();
+	computeAliasTables();
+	if(exportProbabilities)
+		computeProbabilities();
 	roundWeights(m_hhCount);
+	if(integerize)
+		integerizeWeights();
 	clear();
 }
 
+/*
+* @brief Seeds IPU weights with the solution of a previous run, so that reruns with
+*        slightly different constraints start close to the fixed point.
+* @param m_prevWeights Household weights from previous run keyed by PUMS SERIALNO
+* @param householdOnly If true, starts directly with household-only constraints
+*        (corner solution state of the previous run)
+*/
+template<class GenericParams>
+void IPU<GenericParams>::setInitialWeights(const WeightsMap *m_prevWeights, bool householdOnly)
+{
+	if(m_prevWeights != NULL)
+		m_initWeights = *m_prevWeights;
+
+	corner_solution = householdOnly;
+}
+
+/*
+* @brief Selects calibration algorithm
+* @param solver IPU_UPDATING (iterative proportional updating) or 
+*        IPU_RAKING (entropy-maximizing Newton raking)
+*/
+template<class GenericParams>
+void IPU<GenericParams>::setSolver(short int solver)
+{
+	solverType = solver;
+}
+
+/*
+* @brief Sets convergence tolerance on mean relative deviation (gamma) from constraints
+*/
+template<class GenericParams>
+void IPU<GenericParams>::setTolerance(double tolerance)
+{
+	eps = tolerance;
+}
+
+/*
+* @brief Sets maximum number of iterations per solve
+*/
+template<class GenericParams>
+void IPU<GenericParams>::setMaxIterations(int max_iterations)
+{
+	maxIterations = max_iterations;
+}
+
+/*
+* @brief Enables binary convergence trace. Each iteration appends a TraceRecord
+*        (iteration, number of constraints, gamma, delta, elapsed wall time in ms).
+* @param filename Path of trace file
+*/
+template<class GenericParams>
+void IPU<GenericParams>::setTrace(std::string filename)
+{
+	traceFilename = filename;
+}
+
+/*
+* @brief Enables debug export of cumulative household probabilities (ProbMap)
+*/
+template<class GenericParams>
+void IPU<GenericParams>::setExportProbabilities(bool exportProbs)
+{
+	exportProbabilities = exportProbs;
+}
+
+/*
+* @brief Enables deterministic integerization of household weights (see integerizeWeights)
+*/
+template<class GenericParams>
+void IPU<GenericParams>::setIntegerize(bool integer_weights)
+{
+	integerize = integer_weights;
+}
+
 template<class GenericParams>
 bool IPU<GenericParams>::success()
 {
 	return ipu_success;
 }
 
+/*
+* @brief Returns true if IPU fell back to household-only constraints
+*/
+template<class GenericParams>
+bool IPU<GenericParams>::cornerSolution() const
+{
+	return corner_solution;
+}
+
+/*
+* @brief Returns final household weights keyed by PUMS SERIALNO
+*/
+template<class GenericParams>
+const typename IPU<GenericParams>::WeightsMap *IPU<GenericParams>::getWeights() const
+{
+	return &m_weights;
+}
+
 template<class GenericParams>
 const typename IPU<GenericParams>::ProbMap *IPU<GenericParams>::getHHProbability() const
 {
 	return &m_hhProbs;
 }
 
+/*
+* @brief Returns alias tables of households by type, size and income
+*/
+template<class GenericParams>
+const typename IPU<GenericParams>::AliasMap *IPU<GenericParams>::getHHAliasTables() const
+{
+	return &m_aliasTables;
+}
+
+/*
+* @brief Returns integer number of copies of each household (SERIALNO) by household type
+*/
+template<class GenericParams>
+const typename IPU<GenericParams>::ReplicationMap *IPU<GenericParams>::getHHReplications() const
+{
+	return &m_hhReplications;
+}
+
 template<class GenericParams>
 double IPU<GenericParams>::getHHCount(std::string hhType) const
 {
@@ -58,7 +185,10 @@ void IPU<GenericParams>::clearMap()
 {
 	m_hhCount.clear();
 	m_hhProbs.clear();
+	m_aliasTables.clear();
+	m_hhReplications.clear();
 	m_idx.clear();
+	m_weights.clear();
 }
 
 template<class GenericParams>
@@ -74,14 +204,13 @@ void IPU<GenericParams>::initialize()
 
 	weights.set_size(num_rows);
 	weights.fill(1);
+	seedWeights();
 
 	int rowIdx = 0;
 	std::string hhType, hhSize, hhIncCat;
 	std::string sex, ageCat, origin, edu;
 	int hhColIdx, perColIdx;
 
-	std::vector<PersonPums<GenericParams>>personList;
-	
 	for(auto hh = m_households->begin(); hh != m_households->end(); ++hh)
 	{
 		hhType = std::to_string(hh->second.getHouseholdType());
@@ -91,7 +220,7 @@ void IPU<GenericParams>::initialize()
 		hhColIdx = m_idx.at(ACS::Index::Household_GQ).at(hhType+hhSize+hhIncCat);
 		freqMatrix(rowIdx, hhColIdx) = 1.0;
 	
-		personList = hh->second.getPersons();
+		const std::vector<PersonPums<GenericParams>> &personList = hh->second.getPersonList();
 		for(auto pp = personList.begin(); pp != personList.end(); ++pp)
 		{
 			sex = std::to_string(pp->getSex());
@@ -117,7 +246,7 @@ void IPU<GenericParams>::initialize()
 	}	
 
 	mapNonZeroRowIndex(num_cols);
-
+	pruneColumns(num_cols);
 }
 
 template<class GenericParams>
@@ -135,15 +264,20 @@ void IPU<GenericParams>::solve(int row_size, int col_size)
 
 	vec gamma_vals(col_size);
 	vec gamma_vals_new(col_size);
+	gamma_vals.zeros();
+	gamma_vals_new.zeros();
 	
 	double gamma, gamma_new, delta;
 	double col_weighted_sum;
 	std::vector<double>colSum(col_size);
 
+	std::vector<int> activeCols(getActiveColumns(col_size));
+
 	int non_zeros = 0;
 	double sum_gamma = 0;
-	for(int i = 0; i < col_size; ++i)
+	for(size_t c = 0; c < activeCols.size(); ++c)
 	{
+		int i = activeCols[c];
 		//col_weighted_sum = sum(freqMatrix.col(i)%weights);
 		col_weighted_sum = getColWeightSum(i);
 		colSum[i] = col_weighted_sum;
@@ -164,20 +298,19 @@ void IPU<GenericParams>::solve(int row_size, int col_size)
 	bool run_ipu = true;
 	int iterations = 0;
 
-	std::vector<int>rowsIdxList;
-
-	while(run_ipu && iterations <= MAX_ITERATIONS)
+	while(run_ipu && iterations <= maxIterations)
 	{
 		iterations++;
-		for(int j = 0; j < col_size; ++j)
+		for(size_t c = 0; c < activeCols.size(); ++c)
 		{
+			int j = activeCols[c];
 			//col_weighted_sum = sum(freqMatrix.col(j)%weights);
 			col_weighted_sum = getColWeightSum(j);
 			colSum[j] = col_weighted_sum;
 			if(col_weighted_sum != 0)
 			{
 				double ratio = cons[j]/col_weighted_sum;
-				rowsIdxList = m_nonZeroIdx.at(j);
+				const std::vector<int> &rowsIdxList = m_nonZeroIdx.at(j);
 
 				for(size_t k = 0; k < rowsIdxList.size(); ++k)
 					weights(rowsIdxList[k]) = ratio*weights(rowsIdxList[k]);
@@ -186,8 +319,9 @@ void IPU<GenericParams>::solve(int row_size, int col_size)
 
 		
 		double sum_gamma_new = 0;
-		for(int i = 0; i < col_size; ++i)
+		for(size_t c = 0; c < activeCols.size(); ++c)
 		{
+			int i = activeCols[c];
 			//col_weighted_sum = sum(freqMatrix.col(i)%weights);
 			col_weighted_sum = getColWeightSum(i);
 			if(col_weighted_sum != 0) //&& cons[i] > 0.01)
@@ -204,9 +338,7 @@ void IPU<GenericParams>::solve(int row_size, int col_size)
 		
 		delta = fabs(gamma_new-gamma);
 
-		if(printOutput)
-			std::cout << "Improvement run in " << iterations << ":" << std::setprecision(8) 
-			<< "|gamma_new = " << gamma_new << "|gamma = " << gamma << std::endl;
+		logIteration(iterations, col_size, gamma_new, delta);
 
 
 		if(gamma_new < eps)
@@ -221,15 +353,14 @@ void IPU<GenericParams>::solve(int row_size, int col_size)
 			std::cout << std::endl;
 			std::cout << "Corner solution reached!\n" << std::endl;
 				
-			int new_col_size = m_idx.at(ACS::Index::Household_GQ).size();
-			vec hh_cons(new_col_size);
-			for(int i = 0; i < new_col_size; ++i)
-				hh_cons(i) = cons(i);
-
-			cons.resize(new_col_size);
-			cons = hh_cons;
+			//household-only constraints (e.g. warm start) cannot be truncated further
+			if(col_size > (int)m_idx.at(ACS::Index::Household_GQ).size())
+			{
+				corner_solution = true;
+				truncateConstraints();
 
-			solve(row_size, new_col_size);
+				solve(row_size, cons.size());
+			}
 			run_ipu = false;
 		}
 		else{
@@ -239,12 +370,178 @@ void IPU<GenericParams>::solve(int row_size, int col_size)
 			gamma = gamma_new;
 		}
 
-		if(iterations > MAX_ITERATIONS)
+		if(iterations > maxIterations)
 			std::cout << "WARNING: Convergence not achieved!\n" << std::endl;
 	}
 
 }
 
+/*
+* @brief Generalized (exponential) raking - finds weights w = d*exp(X*lambda) closest to 
+*        the initial weights d in entropy distance that match the constraints. Each iteration 
+*        is a damped Newton step on lambda, so convergence takes tens instead of thousands
+*        of iterations. When progress stalls, continues from the current weights with 
+*        household-only constraints instead of restarting.
+* @param row_size Number of households
+* @param col_size Number of constraints
+*/
+template<class GenericParams>
+void IPU<GenericParams>::solveRaking(int row_size, int col_size)
+{
+	if(col_size != (int)cons.size()){
+		std::cout << "Error: Column size of freq. matrix doesn't match constraints size!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	if(row_size != (int)weights.size()){
+		std::cout << "Error: Row size of freq. matrix doesn't match weights size!" << std::endl;
+		exit(EXIT_SUCCESS);
+	}
+
+	//columns without PUMS support cannot be calibrated
+	std::vector<int> activeCols(getActiveColumns(col_size));
+
+	int num_active = activeCols.size();
+	std::cout << "Total number of non-zero columns: " << num_active << std::endl;
+
+	//row-wise view of frequency matrix restricted to active columns
+	std::vector<std::vector<std::pair<int, double>>> rowEntries(row_size);
+	for(int a = 0; a < num_active; ++a)
+	{
+		const std::vector<int> &rowsIdxList = m_nonZeroIdx.at(activeCols[a]);
+		for(size_t k = 0; k < rowsIdxList.size(); ++k)
+			rowEntries[rowsIdxList[k]].push_back(std::make_pair(a, freqMatrix(rowsIdxList[k], activeCols[a])));
+	}
+
+	mat hessian(num_active, num_active);
+	vec residual(num_active), residual_new(num_active), step(num_active);
+	vec prev_weights, direction(row_size);
+
+	double gamma = getRakingResidual(activeCols, residual);
+	double gamma_new, delta = 0;
+	double damping = 1e-6;
+
+	bool run_ipu = true;
+	bool stalled = false;
+	int iterations = 0;
+
+	while(run_ipu && iterations <= maxIterations)
+	{
+		iterations++;
+
+		if(gamma < eps)
+		{
+			if(printOutput)
+				std::cout << "Raking completed after " << iterations-1 << " iterations!\n" << std::endl;
+			run_ipu = false;
+			ipu_success = true;
+			break;
+		}
+
+		//hessian of entropy dual: X' diag(w) X
+		hessian.zeros();
+		for(int i = 0; i < row_size; ++i)
+		{
+			const std::vector<std::pair<int, double>> &entries = rowEntries[i];
+			for(size_t a = 0; a < entries.size(); ++a)
+				for(size_t b = 0; b < entries.size(); ++b)
+					hessian(entries[a].first, entries[b].first) += weights(i)*entries[a].second*entries[b].second;
+		}
+
+		for(int a = 0; a < num_active; ++a)
+			hessian(a, a) += damping*hessian(a, a) + 1e-12;
+
+		prev_weights = weights;
+		double step_size = 1.0;
+		bool accepted = false;
+		gamma_new = gamma;
+
+		if(arma::solve(step, hessian, residual))
+		{
+			for(int i = 0; i < row_size; ++i)
+			{
+				double sum = 0;
+				const std::vector<std::pair<int, double>> &entries = rowEntries[i];
+				for(size_t a = 0; a < entries.size(); ++a)
+					sum += entries[a].second*step(entries[a].first);
+
+				direction(i) = sum;
+			}
+
+			//backtracking line search on mean relative deviation
+			for(int t = 0; t < MAX_LINE_SEARCH && !accepted; ++t)
+			{
+				for(int i = 0; i < row_size; ++i)
+					weights(i) = prev_weights(i)*exp(std::max(-30.0, std::min(30.0, step_size*direction(i))));
+
+				gamma_new = getRakingResidual(activeCols, residual_new);
+				if(gamma_new < gamma)
+					accepted = true;
+				else
+					step_size /= 2;
+			}
+		}
+
+		delta = 0;
+		if(accepted)
+		{
+			delta = fabs(gamma_new-gamma);
+			gamma = gamma_new;
+			residual = residual_new;
+			damping = std::max(damping/10, 1e-9);
+			stalled = (delta < eps/1000);
+		}
+		else
+		{
+			weights = prev_weights;
+			damping *= 10;
+			stalled = (damping > 1e6);
+		}
+
+		logIteration(iterations, col_size, gamma, delta);
+
+		if(stalled && gamma >= eps)
+		{
+			std::cout << std::endl;
+			std::cout << "Corner solution reached!\n" << std::endl;
+
+			if(col_size > (int)m_idx.at(ACS::Index::Household_GQ).size())
+			{
+				corner_solution = true;
+				truncateConstraints();
+
+				solveRaking(row_size, cons.size());
+			}
+			run_ipu = false;
+		}
+
+		if(iterations > maxIterations)
+			std::cout << "WARNING: Convergence not achieved!\n" << std::endl;
+	}
+}
+
+/*
+* @brief Computes constraint residuals (cons - weighted column sums) of active columns
+* @param activeCols Indices of columns with PUMS support
+* @param residual Output residual vector
+* @return Mean relative deviation from constraints (gamma)
+*/
+template<class GenericParams>
+double IPU<GenericParams>::getRakingResidual(const std::vector<int> &activeCols, vec &residual)
+{
+	double sum_gamma = 0;
+	for(size_t a = 0; a < activeCols.size(); ++a)
+	{
+		int j = activeCols[a];
+		double col_weighted_sum = getColWeightSum(j);
+
+		residual(a) = cons[j]-col_weighted_sum;
+		sum_gamma += fabs(residual(a))/cons[j];
+	}
+
+	return (activeCols.size() > 0) ? sum_gamma/activeCols.size() : 0;
+}
+
 template<class GenericParams>
 void IPU<GenericParams>::mapIndexByType(int &num_cols)
 {
@@ -302,23 +599,127 @@ void IPU<GenericParams>::mapNonZeroRowIndex(int num_cols)
 	}
 }
 
+/*
+* @brief Pre-solve pass that removes columns from the iteration set. Columns without PUMS 
+*        support (zero weighted sum) can never be matched and are dropped. Columns of the 
+*        same index type with identical entries always move together, so they are merged 
+*        into one column whose constraint is the mean of the merged constraints.
+* @param num_cols Number of columns of the frequency matrix
+*/
+template<class GenericParams>
+void IPU<GenericParams>::pruneColumns(int num_cols)
+{
+	std::vector<std::string> colNames(num_cols);
+	std::vector<int> colTypes(num_cols);
+	for(auto idx = m_idx.begin(); idx != m_idx.end(); ++idx)
+	{
+		std::string prefix = ACS::Index::_from_integral(idx->first)._to_string();
+		for(auto col = idx->second.begin(); col != idx->second.end(); ++col)
+		{
+			colNames[col->second] = prefix + "_" + col->first;
+			colTypes[col->second] = idx->first;
+		}
+	}
+
+	typedef std::tuple<int, std::vector<int>, std::vector<double>> ColSignature;
+	std::map<ColSignature, int> m_signatures;
+	std::map<int, std::vector<int>> m_merged;
+
+	m_activeCols.clear();
+	m_prunedCols.clear();
+
+	for(int j = 0; j < num_cols; ++j)
+	{
+		const std::vector<int> &rowsIdxList = m_nonZeroIdx.at(j);
+		if(rowsIdxList.size() == 0)
+		{
+			m_prunedCols.push_back(colNames[j]);
+			continue;
+		}
+
+		std::vector<double> values(rowsIdxList.size());
+		for(size_t k = 0; k < rowsIdxList.size(); ++k)
+			values[k] = freqMatrix(rowsIdxList[k], j);
+
+		ColSignature signature(colTypes[j], rowsIdxList, values);
+		auto sig = m_signatures.find(signature);
+		if(sig == m_signatures.end())
+		{
+			m_signatures.insert(std::make_pair(signature, j));
+			m_activeCols.push_back(j);
+		}
+		else
+		{
+			m_merged[sig->second].push_back(j);
+			m_prunedCols.push_back(colNames[j] + "->" + colNames[sig->second]);
+		}
+	}
+
+	int num_merged = 0;
+	for(auto group = m_merged.begin(); group != m_merged.end(); ++group)
+	{
+		double sum_cons = cons[group->first];
+		for(size_t k = 0; k < group->second.size(); ++k)
+			sum_cons += cons[group->second[k]];
+
+		cons[group->first] = sum_cons/(group->second.size()+1);
+		num_merged += group->second.size();
+	}
+
+	std::cout << "Pruned " << m_prunedCols.size()-num_merged << " empty and merged " << num_merged 
+		<< " duplicate columns (" << m_activeCols.size() << " of " << num_cols << " columns remain)" << std::endl;
+
+	if(printOutput)
+	{
+		for(size_t k = 0; k < m_prunedCols.size(); ++k)
+			std::cout << m_prunedCols[k] << ((k+1 < m_prunedCols.size()) ? ", " : "\n");
+		std::cout << std::endl;
+	}
+}
+
+/*
+* @brief Returns columns of the pruned problem that are within first col_size constraints
+*/
+template<class GenericParams>
+std::vector<int> IPU<GenericParams>::getActiveColumns(int col_size) const
+{
+	std::vector<int> activeCols;
+	for(size_t c = 0; c < m_activeCols.size(); ++c)
+		if(m_activeCols[c] < col_size)
+			activeCols.push_back(m_activeCols[c]);
+
+	return activeCols;
+}
+
+/*
+* @brief Returns columns dropped (no PUMS support) or merged ("col->representative") before solve
+*/
+template<class GenericParams>
+const std::vector<std::string> *IPU<GenericParams>::getPrunedColumns() const
+{
+	return &m_prunedCols;
+}
+
 template<class GenericParams>
 double IPU<GenericParams>::getColWeightSum(int colIdx)
 {
 	double sum = 0; 
 
-	std::vector<int> rowsIdxList(m_nonZeroIdx.at(colIdx));
+	const std::vector<int> &rowsIdxList = m_nonZeroIdx.at(colIdx);
 	for(size_t i = 0; i < rowsIdxList.size(); ++i)
 		sum += (freqMatrix(rowsIdxList[i], colIdx) * weights(rowsIdxList[i]));
 	
 	return sum;
 }
 
+/*
+* @brief Groups final household weights (paired with SERIALNO) by household type, size and income
+* @param m_hhWeights Output map of non-empty household types
+*/
 template<class GenericParams>
-void IPU<GenericParams>::computeProbabilities()
+void IPU<GenericParams>::groupWeightsByType(std::map<std::string, std::vector<PairDD>> &m_hhWeights)
 {
 	std::vector<PairDD> weight_hhId;
-	std::map<std::string, std::vector<PairDD>> m_hhWeights;
 
 	std::string gqType = "-1";
 	std::string gqSize = "1";
@@ -355,6 +756,96 @@ void IPU<GenericParams>::computeProbabilities()
 		idx++;
 	}
 
+	for(auto p_vec = m_hhWeights.begin(); p_vec != m_hhWeights.end();)
+	{
+		if(p_vec->second.size() == 0)
+			p_vec = m_hhWeights.erase(p_vec);
+		else
+			++p_vec;
+	}
+}
+
+/*
+* @brief Builds Walker/Vose alias table of households for each household type, so that
+*        each household draw is O(1). Also computes expected household count by type.
+*/
+template<class GenericParams>
+void IPU<GenericParams>::computeAliasTables()
+{
+	std::map<std::string, std::vector<PairDD>> m_hhWeights;
+	groupWeightsByType(m_hhWeights);
+
+	for(auto p_vec = m_hhWeights.begin(); p_vec != m_hhWeights.end(); ++p_vec)
+	{
+		const std::vector<PairDD> &hhWeights = p_vec->second;
+		int size = hhWeights.size();
+
+		double sum_weights = 0;
+		for(int i = 0; i < size; ++i)
+			sum_weights += hhWeights[i].first;
+
+		m_hhCount.insert(std::make_pair(p_vec->first, sum_weights));
+
+		AliasTable table;
+		table.prob.resize(size);
+		table.alias.resize(size);
+		table.hhIdx.resize(size);
+
+		std::vector<double> scaled(size);
+		std::vector<int> small, large;
+		for(int i = 0; i < size; ++i)
+		{
+			table.hhIdx[i] = hhWeights[i].second;
+			scaled[i] = (sum_weights != 0) ? hhWeights[i].first*size/sum_weights : 1.0;
+			if(scaled[i] < 1.0)
+				small.push_back(i);
+			else
+				large.push_back(i);
+		}
+
+		while(!small.empty() && !large.empty())
+		{
+			int less = small.back();
+			int more = large.back();
+			small.pop_back();
+
+			table.prob[less] = scaled[less];
+			table.alias[less] = more;
+
+			scaled[more] = (scaled[more]+scaled[less])-1.0;
+			if(scaled[more] < 1.0)
+			{
+				large.pop_back();
+				small.push_back(more);
+			}
+		}
+
+		//remaining entries are 1 up to rounding error
+		for(size_t i = 0; i < large.size(); ++i)
+		{
+			table.prob[large[i]] = 1.0;
+			table.alias[large[i]] = large[i];
+		}
+		for(size_t i = 0; i < small.size(); ++i)
+		{
+			table.prob[small[i]] = 1.0;
+			table.alias[small[i]] = small[i];
+		}
+
+		m_aliasTables.insert(std::make_pair(p_vec->first, table));
+	}
+}
+
+/*
+* @brief Debug export of household selection probabilities - cumulative probability of 
+*        households by type, bucketed by 0.05. Household draws use alias tables instead.
+*/
+template<class GenericParams>
+void IPU<GenericParams>::computeProbabilities()
+{
+	std::map<std::string, std::vector<PairDD>> m_hhWeights;
+	groupWeightsByType(m_hhWeights);
+
 	double sum_weights = 0;
 
 	int start = 5;
@@ -365,20 +856,13 @@ void IPU<GenericParams>::computeProbabilities()
 	double d_hash = 0;
 	
 	//adds household probabilties to buckets
-	for(auto p_vec = m_hhWeights.begin(); p_vec != m_hhWeights.end();)
+	for(auto p_vec = m_hhWeights.begin(); p_vec != m_hhWeights.end(); ++p_vec)
 	{
-		if(p_vec->second.size() == 0)
-		{
-			p_vec = m_hhWeights.erase(p_vec);
-			continue;
-		}
-
 		std::vector<double>tempWts;
 		for(size_t i = 0; i < p_vec->second.size(); ++i)
 			tempWts.push_back(p_vec->second.at(i).first);
 
 		sum_weights = std::accumulate(tempWts.begin(), tempWts.end(), 0.0);
-		m_hhCount.insert(std::make_pair(p_vec->first, sum_weights));
 
 		for(size_t j = 0; j < tempWts.size(); ++j)
 			tempWts.at(j) = (sum_weights != 0) ? tempWts.at(j)/sum_weights : 0.0;
@@ -409,7 +893,6 @@ void IPU<GenericParams>::computeProbabilities()
 		}
 
 		m_hhProbs.insert(std::make_pair(p_vec->first, hhProbHash));
-		++p_vec;	
 
 		hhProbHash.clear();
 	}
@@ -434,6 +917,179 @@ void IPU<GenericParams>::roundWeights(std::map<std::string, double> &m_hhCount)
 	}
 }
 
+/*
+* @brief Replaces initial weights with weights from previous run matched by SERIALNO.
+*        Households missing from previous run are seeded with mean of matched weights.
+*/
+template<class GenericParams>
+void IPU<GenericParams>::seedWeights()
+{
+	if(m_initWeights.empty())
+		return;
+
+	int rowIdx = 0;
+	int matched = 0;
+	double sum_weights = 0;
+	std::vector<bool>found(weights.size(), false);
+
+	for(auto hh = m_households->begin(); hh != m_households->end(); ++hh)
+	{
+		auto wt = m_initWeights.find(hh->first);
+		if(wt != m_initWeights.end() && wt->second > 0)
+		{
+			weights(rowIdx) = wt->second;
+			found[rowIdx] = true;
+			sum_weights += wt->second;
+			matched++;
+		}
+		rowIdx++;
+	}
+
+	double mean_weight = (matched > 0) ? sum_weights/matched : 1.0;
+	for(size_t i = 0; i < found.size(); ++i)
+		if(!found[i])
+			weights(i) = mean_weight;
+
+	if(printOutput)
+		std::cout << "IPU warm start: " << matched << " of " << weights.size() 
+		<< " households seeded from previous solution" << std::endl;
+
+	m_initWeights.clear();
+}
+
+/*
+* @brief Stores final household weights keyed by SERIALNO, to warm-start later runs
+*/
+template<class GenericParams>
+void IPU<GenericParams>::saveWeights()
+{
+	m_weights.clear();
+
+	int rowIdx = 0;
+	for(auto hh = m_households->begin(); hh != m_households->end(); ++hh)
+		m_weights.insert(std::make_pair(hh->first, weights(rowIdx++)));
+}
+
+/*
+* @brief Drops person constraints, keeping only household/GQ constraints
+*/
+template<class GenericParams>
+void IPU<GenericParams>::truncateConstraints()
+{
+	int new_col_size = m_idx.at(ACS::Index::Household_GQ).size();
+	vec hh_cons(new_col_size);
+	for(int i = 0; i < new_col_size; ++i)
+		hh_cons(i) = cons(i);
+
+	cons.resize(new_col_size);
+	cons = hh_cons;
+}
+
+/*
+* @brief Opens binary trace file (if enabled) and starts solve timers
+*/
+template<class GenericParams>
+void IPU<GenericParams>::openTrace()
+{
+	solveTimer.start();
+	printTimer.start();
+
+	if(traceFilename.empty())
+		return;
+
+	traceFile.open(traceFilename, std::ios::out | std::ios::binary | std::ios::trunc);
+	if(!traceFile.is_open())
+		std::cout << "WARNING: Unable to open IPU trace file " << traceFilename << std::endl;
+}
+
+template<class GenericParams>
+void IPU<GenericParams>::closeTrace()
+{
+	if(traceFile.is_open())
+		traceFile.close();
+}
+
+/*
+* @brief Records convergence of one iteration to the trace file and prints progress 
+*        to console at most once every PRINT_WAIT_TIME ms
+*/
+template<class GenericParams>
+void IPU<GenericParams>::logIteration(int iteration, int col_size, double gamma, double delta)
+{
+	solveTimer.stop();
+
+	if(traceFile.is_open())
+	{
+		TraceRecord record;
+		record.iteration = iteration;
+		record.num_cols = col_size;
+		record.gamma = gamma;
+		record.delta = delta;
+		record.wall_ms = solveTimer.elapsed_ms();
+
+		traceFile.write(reinterpret_cast<const char*>(&record), sizeof(TraceRecord));
+	}
+
+	printTimer.stop();
+	if(printOutput && printTimer.elapsed_ms() > PRINT_WAIT_TIME)
+	{
+		std::cout << "Improvement run in " << iteration << ":" << std::setprecision(8) 
+			<< "|gamma = " << gamma << "|delta = " << delta << std::endl;
+		printTimer.start();
+	}
+}
+
+/*
+* @brief Converts household weights into integer number of copies of each household. Within 
+*        each household type, weights are scaled to the rounded household count (m_hhCount), 
+*        the integer part of each weight is kept (truncate-replicate) and the remaining 
+*        households are assigned to the largest fractional parts. Unlike the sampling step of 
+*        TRS this is deterministic, and totals match m_hhCount exactly.
+*/
+template<class GenericParams>
+void IPU<GenericParams>::integerizeWeights()
+{
+	std::map<std::string, std::vector<PairDD>> m_hhWeights;
+	groupWeightsByType(m_hhWeights);
+
+	for(auto p_vec = m_hhWeights.begin(); p_vec != m_hhWeights.end(); ++p_vec)
+	{
+		const std::vector<PairDD> &hhWeights = p_vec->second;
+		int target = (int)getHHCount(p_vec->first);
+		if(target <= 0)
+			continue;
+
+		double sum_weights = 0;
+		for(size_t i = 0; i < hhWeights.size(); ++i)
+			sum_weights += hhWeights[i].first;
+
+		std::vector<PairDblInt> replications(hhWeights.size());
+		std::vector<PairDD> remainders(hhWeights.size());
+
+		int total = 0;
+		for(size_t i = 0; i < hhWeights.size(); ++i)
+		{
+			double scaled = (sum_weights != 0) ? hhWeights[i].first*target/sum_weights : (double)target/hhWeights.size();
+			int copies = (int)floor(scaled);
+
+			replications[i] = PairDblInt(hhWeights[i].second, copies);
+			remainders[i] = PairDD(scaled-copies, i);
+			total += copies;
+		}
+
+		//largest remainders first, ties broken by position (SERIALNO order)
+		std::sort(remainders.begin(), remainders.end(), [](const PairDD &a, const PairDD &b) 
+		{ 
+			return (a.first != b.first) ? a.first > b.first : a.second < b.second; 
+		});
+
+		for(int k = 0; total < target; ++k, ++total)
+			replications[(int)remainders[k % remainders.size()].second].second++;
+
+		m_hhReplications.insert(std::make_pair(p_vec->first, replications));
+	}
+}
+
 template<class GenericParams>
 void IPU<GenericParams>::clear()
 {
@@ -441,6 +1097,7 @@ void IPU<GenericParams>::clear()
 	cons.clear();
 	weights.clear();
 	m_idx.clear();
+	m_activeCols.clear();
 }
 
 
@@ -37,7 +37,7 @@ template class IPUWrapper<DepressionParams>;
 */
 template<class GenericParams>
 IPUWrapper<GenericParams>::IPUWrapper(std::shared_ptr<GenericParams>param, ACSEstimates *m_acsEst, CountyMap *mapCountyPuma) : 
-	parameters(param), m_acsEstimates(m_acsEst), m_pumaCounty(mapCountyPuma)
+	parameters(param), m_acsEstimates(m_acsEst), m_pumaCounty(mapCountyPuma), warmCorner(false)
 {
 }
 
@@ -80,6 +80,15 @@ void IPUWrapper<GenericParams>::startIPU(std::string geoID, std::string areaAbbv
 
 	if(run){
 		ipu = new IPU<GenericParams>(&m_householdPUMS, ipuCons, true);
+		ipu->setSolver(parameters->getIPUSolver());
+		ipu->setTolerance(parameters->getIPUTolerance());
+		ipu->setMaxIterations(parameters->getIPUMaxIterations());
+		ipu->setExportProbabilities(parameters->exportIPUProbabilities());
+		ipu->setIntegerize(parameters->integerizeWeights());
+		if(parameters->traceIPU())
+			ipu->setTrace(parameters->getOutputDir() + "ipu_trace_" + geoID + ".bin");
+		if(!m_warmWeights.empty() || warmCorner)
+			ipu->setInitialWeights(&m_warmWeights, warmCorner);
 		ipu->start();
 	}
 	else{
@@ -89,6 +98,21 @@ void IPUWrapper<GenericParams>::startIPU(std::string geoID, std::string areaAbbv
 
 }
 
+/*
+* @brief Seeds the next IPU run with household weights of a previous solution
+* @param m_weights Household weights keyed by PUMS SERIALNO (see getHouseholdWeights)
+* @param householdOnly Carries over household-only (corner solution) state of previous run
+*/
+template<class GenericParams>
+void IPUWrapper<GenericParams>::setWarmStart(const WeightsMap *m_weights, bool householdOnly)
+{
+	m_warmWeights.clear();
+	if(m_weights != NULL)
+		m_warmWeights = *m_weights;
+
+	warmCorner = householdOnly;
+}
+
 /*
 * @brief Returns true if IPU is successfully completed
 */
@@ -98,6 +122,33 @@ bool IPUWrapper<GenericParams>::successIPU()
 	return ipu->success();
 }
 
+/*
+* @brief Returns true if IPU ended with household-only constraints
+*/
+template<class GenericParams>
+bool IPUWrapper<GenericParams>::cornerSolutionIPU() const
+{
+	return ipu->cornerSolution();
+}
+
+/*
+* @brief Returns final IPU household weights keyed by PUMS SERIALNO
+*/
+template<class GenericParams>
+const typename IPUWrapper<GenericParams>::WeightsMap * IPUWrapper<GenericParams>::getHouseholdWeights() const
+{
+	return ipu->getWeights();
+}
+
+/*
+* @brief Returns IPU columns dropped or merged before solve
+*/
+template<class GenericParams>
+const typename IPUWrapper<GenericParams>::Columns * IPUWrapper<GenericParams>::getPrunedColumns() const
+{
+	return ipu->getPrunedColumns();
+}
+
 //template<class GenericParams>
 //typename const IPUWrapper<GenericParams>::ProbMap * IPUWrapper<GenericParams>::getHouseholdProbability() const
 //{
@@ -105,7 +156,8 @@ bool IPUWrapper<GenericParams>::successIPU()
 //}
 
 /*
-* @brief Returns household selection probability from IPU
+* @brief Returns household selection probability from IPU (debug export, empty unless
+*        enabled with 'export_prob_map' in ipu_params.csv)
 */
 template<class GenericParams>
 const typename IPUWrapper<GenericParams>::ProbMap * IPUWrapper<GenericParams>::getHouseholdProbability() const
@@ -113,6 +165,25 @@ const typename IPUWrapper<GenericParams>::ProbMap * IPUWrapper<GenericParams>::g
 	return ipu->getHHProbability();
 }
 
+/*
+* @brief Returns integer number of copies of each household by type, size and income
+*        (empty unless 'integerize' is set in run_params.csv)
+*/
+template<class GenericParams>
+const typename IPUWrapper<GenericParams>::ReplicationMap * IPUWrapper<GenericParams>::getHouseholdReplications() const
+{
+	return ipu->getHHReplications();
+}
+
+/*
+* @brief Returns alias tables for drawing households by type, size and income
+*/
+template<class GenericParams>
+const typename IPUWrapper<GenericParams>::AliasMap * IPUWrapper<GenericParams>::getHouseholdAliasTables() const
+{
+	return ipu->getHHAliasTables();
+}
+
 //template<class GenericParams>
 //typename const IPUWrapper<GenericParams>::HouseholdsMap * IPUWrapper<GenericParams>::getHouseholds() const
 //{
@@ -457,7 +528,6 @@ template<class GenericParams>
 void IPUWrapper<GenericParams>::refineHHPumsList()
 {
 	std::map<std::string, double> m_personCons(getConstraintsMap());
-	std::vector<PersonPums<GenericParams>> hhPersons;
 
 	std::cout << "PUMS households before refinement: " << m_householdPUMS.size() <<  std::endl;
 
@@ -466,9 +536,16 @@ void IPUWrapper<GenericParams>::refineHHPumsList()
 
 	bool valid_person;
 
+	//person types are resolved once to their person pool index, which is also 
+	//their code in the counter (see Counter::initPersonCounter)
+	std::map<std::string, int> poolIdx;
+	const Parameters::Pool *personPool = parameters->getPersonPool();
+	for(size_t pp = 0; pp < personPool->size(); ++pp)
+		poolIdx.insert(std::make_pair(personPool->at(pp), (int)pp));
+
 	for(auto hh = m_householdPUMS.begin(); hh != m_householdPUMS.end();)
 	{
-		hhPersons = hh->second.getPersons();
+		const std::vector<PersonPums<GenericParams>> &hhPersons = hh->second.getPersonList();
 		for(auto pp = hhPersons.begin(); pp != hhPersons.end(); ++pp)
 		{
 			sex = std::to_string(pp->getSex());
@@ -499,7 +576,10 @@ void IPUWrapper<GenericParams>::refineHHPumsList()
 		if(!valid_person)
 			hh = m_householdPUMS.erase(hh);
 		else
+		{
+			hh->second.setPersonTypes(poolIdx);
 			++hh;
+		}
 	}
 	
 	std::cout << "PUMS households after refinement: " << m_householdPUMS.size() << std::endl << std::endl;
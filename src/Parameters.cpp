@@ -23,13 +23,17 @@
 Parameters::Parameters() {}
 
 Parameters::Parameters(const char *inDir, const char *outDir, const int simModel, const int geoLvl) : 
-	inputDir(inDir), outputDir(outDir), alpha(0.05), minSampleSize(1000.0), max_draws(20), simType(simModel), 
-	geoLevel(geoLvl), output(true)
+	inputDir(inDir), outputDir(outDir), alpha(0.05), minSampleSize(1000.0), max_draws(20), ipuSolver(IPU_UPDATING), 
+	ipuTolerance(1e-3), ipuMaxIterations(4000), ipuTrace(false), 
+	ipuExportProbs(false), numThreads(1), numTrialThreads(1), seed(0), fitRepair(false), 
+	integerWeights(false), profileCompression(false), commonRandom(false), simType(simModel), geoLevel(geoLvl), output(true)
 {
 	readACSCodeBookFile();
 	readAgeGenderMappingFile();
 	readHHIncomeMappingFile();
 	readOriginListFile();
+	readIPUParamsFile();
+	readRunParamsFile();
 
 	createHouseholdPool();
 	createPersonPool();
@@ -195,6 +199,66 @@ int Parameters::getMaxDraws() const
 	return max_draws;
 }
 
+short int Parameters::getIPUSolver() const
+{
+	return ipuSolver;
+}
+
+double Parameters::getIPUTolerance() const
+{
+	return ipuTolerance;
+}
+
+int Parameters::getIPUMaxIterations() const
+{
+	return ipuMaxIterations;
+}
+
+bool Parameters::traceIPU() const
+{
+	return ipuTrace;
+}
+
+bool Parameters::exportIPUProbabilities() const
+{
+	return ipuExportProbs;
+}
+
+int Parameters::getNumThreads() const
+{
+	return numThreads;
+}
+
+int Parameters::getNumTrialThreads() const
+{
+	return numTrialThreads;
+}
+
+unsigned int Parameters::getSeed() const
+{
+	return seed;
+}
+
+bool Parameters::repairFit() const
+{
+	return fitRepair;
+}
+
+bool Parameters::integerizeWeights() const
+{
+	return integerWeights;
+}
+
+bool Parameters::compressProfiles() const
+{
+	return profileCompression;
+}
+
+bool Parameters::commonRandomNumbers() const
+{
+	return commonRandom;
+}
+
 short int Parameters::getSimType() const
 {
 	return simType;
@@ -398,6 +462,83 @@ void Parameters::readOriginListFile()
 		m_originByRace.insert(std::make_pair(row->front(), std::stoi(row->back())));
 }
 
+/**
+*	@brief Reads optional IPU settings (calibration algorithm, tolerance, iteration 
+*	cap, convergence trace and probability export). Defaults are kept when the file is not present.
+*	@param none
+*	@return void
+*/
+void Parameters::readIPUParamsFile()
+{
+	const char *ipuFile = getFilePath("variables/ipu_params.csv");
+	std::ifstream infile(ipuFile);
+	if(!infile.good())
+		return;
+	infile.close();
+
+	io::CSVReader<2>ipu_params(ipuFile);
+	ipu_params.read_header(io::ignore_extra_column, "Variable", "Value");
+
+	const char* var = NULL;
+	const char* val = NULL;
+
+	while(ipu_params.read_row(var, val))
+	{
+		std::string variable(var);
+		if(variable == "solver")
+			ipuSolver = (std::string(val) == "raking") ? IPU_RAKING : IPU_UPDATING;
+		else if(variable == "tolerance")
+			ipuTolerance = std::stod(val);
+		else if(variable == "max_iterations")
+			ipuMaxIterations = std::stoi(val);
+		else if(variable == "trace")
+			ipuTrace = (std::stoi(val) != 0);
+		else if(variable == "export_prob_map")
+			ipuExportProbs = (std::stoi(val) != 0);
+	}
+}
+
+/**
+*	@brief Reads optional run settings (number of worker threads, number of trials run 
+*	concurrently, master seed of trials (0 = seeded from clock), repair of poorly fitting draws, 
+*	integerized instead of random household draws, evaluation of CHD risk once per 
+*	distinct risk profile, common random numbers of agents across intervention scenarios). Defaults are kept when the file is not present.
+*	@param none
+*	@return void
+*/
+void Parameters::readRunParamsFile()
+{
+	const char *runFile = getFilePath("variables/run_params.csv");
+	std::ifstream infile(runFile);
+	if(!infile.good())
+		return;
+	infile.close();
+
+	io::CSVReader<2>run_params(runFile);
+	run_params.read_header(io::ignore_extra_column, "Variable", "Value");
+
+	const char* var = NULL;
+	const char* val = NULL;
+
+	while(run_params.read_row(var, val))
+	{
+		std::string variable(var);
+		if(variable == "threads")
+			numThreads = std::max(1, std::stoi(val));
+		else if(variable == "trial_threads")
+			numTrialThreads = std::max(1, std::stoi(val));
+		else if(variable == "seed")
+			seed = (unsigned int)std::stoul(val);
+		else if(variable == "repair_fit")
+			fitRepair = (std::stoi(val) != 0);
+		else if(variable == "integerize")
+			integerWeights = (std::stoi(val) != 0);
+		else if(variable == "compress_profiles")
+			profileCompression = (std::stoi(val) != 0);
+		else if(variable == "common_random")
+			commonRandom = (std::stoi(val) != 0);
+	}
+}
 
 /**
 *	@brief Creates pool of group-quarters and households by type, size and income.
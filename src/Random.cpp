@@ -4,6 +4,10 @@ Random::Random() : rng((uint32_t)time(NULL))
 {
 }
 
+Random::Random(unsigned int seed) : rng((uint32_t)seed)
+{
+}
+
 Random::~Random()
 {
 }
@@ -48,3 +52,37 @@ int Random::poisson_dist(double mean)
 
 	return generator();
 }
+
+RandomStream::RandomStream() : state(0)
+{
+}
+
+/*
+* @brief Restarts the stream
+* @param key Key of the owner of the stream (e.g. seed of an agent)
+* @param stream Index of the stream of the owner
+*/
+void RandomStream::seed(unsigned int key, int stream)
+{
+	state = ((uint64_t)key << 32) | (uint32_t)stream;
+	next();
+}
+
+double RandomStream::uniform_real_dist()
+{
+	return (next() >> 11)*(1.0/9007199254740992.0);
+}
+
+int RandomStream::random_int(int min, int max)
+{
+	int value = min + (int)(uniform_real_dist()*(max - min + 1));
+	return (value > max) ? max : value;
+}
+
+uint64_t RandomStream::next()
+{
+	uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+	z = (z ^ (z >> 30))*0xBF58476D1CE4E5B9ULL;
+	z = (z ^ (z >> 27))*0x94D049BB133111EBULL;
+	return z ^ (z >> 31);
+}
@@ -394,6 +394,16 @@ bool ViolenceAgent::watchesNews(double pNewsSource)
 		return false;
 }
 
+void ViolenceAgent::setCounter(ViolenceCounter *count)
+{
+	this->counter = count;
+}
+
+void ViolenceAgent::setRandom(Random *rand)
+{
+	this->random = rand;
+}
+
 void ViolenceAgent::setAgentIdx(std::string idx)
 {
 	this->agentIdx = idx;
@@ -471,7 +481,7 @@ void ViolenceAgent::setPTSDx(MapTuple *m_ptsdx)
 		if(m_ptsdx->count(key_ptsd) > 0)
 		{
 			Tuple tup_ptsdx = m_ptsdx->at(key_ptsd);
-			double ptsdx_ = getPTSDx(tup_ptsdx, key_ptsd);
+			double ptsdx_ = getPTSDx(tup_ptsdx);
 
 			for(int i = 0; i < NUM_TREATMENT; ++i)
 				this->ptsdx[i] = ptsdx_;
@@ -510,7 +520,7 @@ void ViolenceAgent::setPTSDcase(bool ptsd_case)
 	this->ptsdCase = ptsd_case;
 	if(this->ptsdCase)
 	{
-		counter->addPersonCount("Ptsd" + getAgentType3()); 
+		counter->addPtsdSourceNewsCount(ageCat2, newsSource); 
 	}
 }
 
@@ -558,13 +568,13 @@ void ViolenceAgent::setNumberOfTvHours()
 	}
 
 	//counter->addPersonCount(getAgentType1());
-	counter->addPersonCount(getAgentType2());
+	counter->addHoursWatchedCount(ageCat2, hoursWatched);
 }
 
 void ViolenceAgent::setNumberofTvHours(int numHours)
 {
 	this->hoursWatched = numHours;
-	counter->addPersonCount(getAgentType2());
+	counter->addHoursWatchedCount(ageCat2, hoursWatched);
 }
 
 void ViolenceAgent::setSocialMediaHours()
@@ -584,13 +594,13 @@ void ViolenceAgent::setSocialMediaHours()
 		}
 	}
 
-	counter->addPersonCount(getAgentType4());
+	counter->addSocialMediaHoursCount(ageCat2, socialMediaHours);
 }
 
 void ViolenceAgent::setSocialMediaHours(int numHours)
 {
 	this->socialMediaHours = numHours;
-	counter->addPersonCount(getAgentType4());
+	counter->addSocialMediaHoursCount(ageCat2, socialMediaHours);
 }
 
 void ViolenceAgent::setNewsSource(VecPairs *vMediaDist)
@@ -617,8 +627,8 @@ void ViolenceAgent::setNewsSource(VecPairs *vMediaDist)
 	if(this->newsSource == Violence::Source::SocialMedia)
 		setSocialMediaHours();
 	
-	counter->addPersonCount(getAgentType3());
-	counter->addPersonCount(getAgentType1());
+	counter->addSourceNewsCount(ageCat2, newsSource);
+	counter->addAgeCatCount(ageCat2);
 }
 
 void ViolenceAgent::setDummyVariables()
@@ -727,29 +737,29 @@ double ViolenceAgent::getPTSDx(int treatment) const
 //	return ptsdx_;
 //}
 
-double ViolenceAgent::getPTSDx(Tuple tup_ptsdx, std::string key) const
+double ViolenceAgent::getPTSDx(Tuple tup_ptsdx) const
 {
 	double randP = random->uniform_real_dist();
 	double ptsdx_ = -1;
 	if (randP < FIRST_Q)
 	{
 		ptsdx_ = std::get<0>(tup_ptsdx);
-		counter->addPersonCount(key, "1Q");
+		counter->addPtsdxQuartileCount(sex, ageCat, getPtsdType(), getPtsdCase(), 1);
 	}
 	else if(randP < SECOND_Q)
 	{
 		ptsdx_ = std::get<1>(tup_ptsdx);
-		counter->addPersonCount(key, "2Q");
+		counter->addPtsdxQuartileCount(sex, ageCat, getPtsdType(), getPtsdCase(), 2);
 	}
 	else if(randP < THIRD_Q)
 	{
 		ptsdx_ = std::get<2>(tup_ptsdx);
-		counter->addPersonCount(key, "3Q");
+		counter->addPtsdxQuartileCount(sex, ageCat, getPtsdType(), getPtsdCase(), 3);
 	}
 	else if(randP < FOURTH_Q)
 	{
 		ptsdx_ = std::get<3>(tup_ptsdx);
-		counter->addPersonCount(key, "4Q");
+		counter->addPtsdxQuartileCount(sex, ageCat, getPtsdType(), getPtsdCase(), 4);
 	}
 
 	return ptsdx_;
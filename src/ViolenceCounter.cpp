@@ -1,6 +1,41 @@
 #include "ViolenceCounter.h"
 #include "ViolenceParams.h"
 
+namespace
+{
+	//adds outcome totals of a trial into totals of same schema
+	void addTotals(double &dst, const double &src)
+	{
+		dst += src;
+	}
+
+	void addTotals(Outcomes &dst, const Outcomes &src)
+	{
+		for(int i = 0; i < NUM_TREATMENT; ++i)
+			dst.value[i] += src.value[i];
+
+		dst.diff += src.diff;
+		dst.ratio += src.ratio;
+	}
+
+	template<class Value>
+	void addTotals(std::vector<Value> &dst, const std::vector<Value> &src)
+	{
+		if(dst.size() < src.size())
+			dst.resize(src.size(), Value());
+
+		for(size_t i = 0; i < src.size(); ++i)
+			addTotals(dst[i], src[i]);
+	}
+
+	template<class Key, class Value>
+	void addTotals(std::map<Key, Value> &dst, const std::map<Key, Value> &src)
+	{
+		for(auto it = src.begin(); it != src.end(); ++it)
+			addTotals(dst[it->first], it->second);
+	}
+}
+
 ViolenceCounter::ViolenceCounter()
 {
 }
@@ -21,6 +56,94 @@ void ViolenceCounter::initialize()
 
 }
 
+/*
+* @brief Initializes a thread-local counter (shard) with person type codes and empty PTSD 
+*        and treatment counters
+* @param master Counter the shard will be merged into
+*/
+void ViolenceCounter::initShard(const ViolenceCounter &master)
+{
+	param = master.param;
+	totalPrevalence = 0;
+	initPersonCounter(param);
+	initPtsdCounter();
+}
+
+/*
+* @brief Adds PTSD and treatment counts accumulated by a thread-local counter (shard)
+* @param shard Thread-local counter
+*/
+void ViolenceCounter::merge(const ViolenceCounter &shard)
+{
+	Counter<ViolenceParams>::merge(shard);
+
+	nonPtsdCountSC += shard.nonPtsdCountSC;
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		for(int j = 0; j < NUM_PTSD; ++j)
+		{
+			for(size_t tick = 0; tick < shard.m_ptsdCount[i][j].size(); ++tick)
+			{
+				m_ptsdCount[i][j][tick] += shard.m_ptsdCount[i][j][tick];
+				m_ptsdResolvedCount[i][j][tick] += shard.m_ptsdResolvedCount[i][j][tick];
+			}
+		}
+
+		for(int k = 0; k < NUM_CASES; ++k)
+		{
+			for(size_t year = 0; year < shard.m_totCbt[i][k].size(); ++year)
+			{
+				m_totCbt[i][k][year] += shard.m_totCbt[i][k][year];
+				m_totSpr[i][k][year] += shard.m_totSpr[i][k][year];
+			}
+		}
+
+		for(size_t tick = 0; tick < shard.m_cbtReach[i].size(); ++tick)
+		{
+			m_cbtReach[i][tick] += shard.m_cbtReach[i][tick];
+			m_sprReach[i][tick] += shard.m_sprReach[i][tick];
+		}
+	}
+
+	for(size_t tick = 0; tick < shard.m_cbtCount.size(); ++tick)
+	{
+		m_cbtCount[tick] += shard.m_cbtCount[tick];
+		m_sprCount[tick] += shard.m_sprCount[tick];
+		m_ndCount[tick] += shard.m_ndCount[tick];
+	}
+}
+
+/*
+* @brief Adds outcome totals (summed over trials) of the counter of a trial
+* @param trial Counter of a trial
+*/
+void ViolenceCounter::mergeOutcomes(const ViolenceCounter &trial)
+{
+	totalPrevalence += trial.totalPrevalence;
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+	{
+		for(int j = 0; j < NUM_PTSD; ++j)
+		{
+			addTotals(m_totPrev[i][j], trial.m_totPrev[i][j]);
+			addTotals(m_totRecovery[i][j], trial.m_totRecovery[i][j]);
+		}
+
+		addTotals(totalReach[i], trial.totalReach[i]);
+	}
+
+	addTotals(m_prevalence, trial.m_prevalence);
+	addTotals(m_recovery, trial.m_recovery);
+
+	addTotals(m_totDalys, trial.m_totDalys);
+	addTotals(m_totPtsdFreeWeeks, trial.m_totPtsdFreeWeeks);
+	addTotals(m_totCost, trial.m_totCost);
+	addTotals(m_avgCost, trial.m_avgCost);
+
+	addTotals(m_totalPrevalence2, trial.m_totalPrevalence2);
+	addTotals(m_totalPtsdCases, trial.m_totalPtsdCases);
+	addTotals(m_totalPopulation, trial.m_totalPopulation);
+}
+
 void ViolenceCounter::output(std::string geoID, std::string modelNumber)
 {
 	//outputHouseholdCounts(param, geoID);
@@ -48,21 +171,28 @@ void ViolenceCounter::initPtsdCounter()
 	{
 		for(int j = 0; j < NUM_PTSD; ++j)
 		{
-			for(int k = 0; k < num_steps; ++k)
+			m_ptsdCount[i][j].assign(num_steps, 0);
+			m_ptsdResolvedCount[i][j].assign(num_steps, 0);
+
+			//outcomes are summed over trials
+			if(m_totPrev[i][j].size() < (size_t)num_steps)
 			{
-				m_ptsdCount[i][j].insert(std::make_pair(k, 0));
-				m_ptsdResolvedCount[i][j].insert(std::make_pair(k, 0));
+				m_totPrev[i][j].resize(num_steps, 0);
+				m_totRecovery[i][j].resize(num_steps, 0);
+			}
+		}
 
-				if(j == 0)
-				{
-					m_cbtReach[i].insert(std::make_pair(k, 0));
-					m_sprReach[i].insert(std::make_pair(k, 0));
+		m_cbtReach[i].assign(num_steps, 0);
+		m_sprReach[i].assign(num_steps, 0);
 
-					if(totalReach[i].size() < num_steps)
-						totalReach[i].push_back(0);
-				}
-			}	
-		}
+		if(totalReach[i].size() < (size_t)num_steps)
+			totalReach[i].resize(num_steps, 0);
+	}
+
+	if(m_prevalence.size() < (size_t)num_steps)
+	{
+		m_prevalence.resize(num_steps, Outcomes());
+		m_recovery.resize(num_steps, Outcomes());
 	}
 
 	initTreatmentCounter(num_steps);
@@ -71,33 +201,156 @@ void ViolenceCounter::initPtsdCounter()
 
 void ViolenceCounter::initTreatmentCounter(int steps)
 {
-	for(int i = 0; i < steps; ++i)
+	m_cbtCount.assign(steps, 0);
+	m_sprCount.assign(steps, 0);
+	m_ndCount.assign(steps, 0);
+
+	for(int j = 0; j < NUM_TREATMENT; ++j)
+	{
+		for(int k = 0; k < NUM_CASES; ++k)
+		{
+			m_totCbt[j][k].assign(steps/WEEKS_IN_YEAR, 0);
+			m_totSpr[j][k].assign(steps/WEEKS_IN_YEAR, 0);
+		}
+	}
+
+}
+
+/*
+* @brief Registers agent types counted by agents: population, hours of TV watched, news source, 
+*        PTSD cases by news source and social media hours by age cat2, and PTSDx quartiles by 
+*        sex, age cat, PTSD type and PTSD case
+*/
+void ViolenceCounter::registerAgentTypes()
+{
+	m_ageCatCodes.clear();
+	m_hoursWatchedCodes.clear();
+	m_sourceNewsCodes.clear();
+	m_ptsdSourceNewsCodes.clear();
+	m_socialMediaCodes.clear();
+	m_ptsdxCodes.clear();
+
+	for(auto ageCat2 : Violence::AgeCat2::_values())
 	{
-		m_cbtCount.insert(std::make_pair(i, 0));
-		m_sprCount.insert(std::make_pair(i, 0));
-		m_ndCount.insert(std::make_pair(i, 0));
+		std::string ageCat = std::to_string(ageCat2);
+		m_ageCatCodes.push_back(registerPersonType("AgeCat2" + ageCat));
+
+		//hours watched is 0 for agents not watching TV
+		for(size_t hours = 0; hours <= Violence::Coverage::_size(); ++hours)
+			m_hoursWatchedCodes.push_back(registerPersonType("HoursWatched" + ageCat + std::to_string(hours)));
+
+		for(auto source : Violence::Source::_values())
+		{
+			m_sourceNewsCodes.push_back(registerPersonType("SourceNews" + ageCat + std::to_string(source)));
+			m_ptsdSourceNewsCodes.push_back(registerPersonType("PtsdSourceNews" + ageCat + std::to_string(source)));
+		}
 
+		for(auto hours : Violence::SocialMediaHours::_values())
+			m_socialMediaCodes.push_back(registerPersonType("SocialMediaHours" + ageCat + std::to_string(hours)));
 	}
 
-	for(int i = 0; i < steps/WEEKS_IN_YEAR; ++i)
+	for(auto sex : Violence::Sex::_values())
 	{
-		//m_totCbt.insert(std::make_pair(i, 0));
-		for(int j = 0; j < NUM_TREATMENT; ++j)
+		for(auto ageCat : Violence::AgeCat::_values())
 		{
-			for(int k = 0; k < NUM_CASES; ++k)
+			for(int ptsdType = 0; ptsdType < NUM_PTSD; ++ptsdType)
 			{
-				m_totCbt[j][k].insert(std::make_pair(i, 0));
-				m_totSpr[j][k].insert(std::make_pair(i, 0));
+				for(int ptsdCase = 0; ptsdCase < NUM_CASES; ++ptsdCase)
+				{
+					std::string key = std::to_string(sex) + std::to_string(ageCat) + std::to_string(ptsdType) + std::to_string(ptsdCase);
+					for(int q = 1; q <= NUM_QUARTILES; ++q)
+						m_ptsdxCodes.push_back(registerPersonType(key + std::to_string(q) + "Q"));
+				}
 			}
 		}
 	}
+}
+
+/*
+* @brief Counts agent by age cat2
+*/
+void ViolenceCounter::addAgeCatCount(int ageCat2)
+{
+	int code = getTableCode(m_ageCatCodes, ageCat2-1, 0, 1);
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("AgeCat2" + std::to_string(ageCat2));
+}
+
+/*
+* @brief Counts agent by age cat2 and hours of TV watched
+*/
+void ViolenceCounter::addHoursWatchedCount(int ageCat2, int hours)
+{
+	int code = getTableCode(m_hoursWatchedCodes, ageCat2-1, hours, Violence::Coverage::_size()+1);
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("HoursWatched" + std::to_string(ageCat2) + std::to_string(hours));
+}
+
+/*
+* @brief Counts agent by age cat2 and news source
+*/
+void ViolenceCounter::addSourceNewsCount(int ageCat2, int source)
+{
+	int code = getTableCode(m_sourceNewsCodes, ageCat2-1, source, Violence::Source::_size());
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("SourceNews" + std::to_string(ageCat2) + std::to_string(source));
+}
+
+/*
+* @brief Counts PTSD case by age cat2 and news source
+*/
+void ViolenceCounter::addPtsdSourceNewsCount(int ageCat2, int source)
+{
+	int code = getTableCode(m_ptsdSourceNewsCodes, ageCat2-1, source, Violence::Source::_size());
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("PtsdSourceNews" + std::to_string(ageCat2) + std::to_string(source));
+}
+
+/*
+* @brief Counts agent by age cat2 and hours of social media use
+*/
+void ViolenceCounter::addSocialMediaHoursCount(int ageCat2, int hours)
+{
+	int code = getTableCode(m_socialMediaCodes, ageCat2-1, hours, Violence::SocialMediaHours::_size());
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount("SocialMediaHours" + std::to_string(ageCat2) + std::to_string(hours));
+}
+
+/*
+* @brief Counts agent by sex, age cat, PTSD type, PTSD case and PTSDx quartile
+* @param quartile PTSDx quartile (1 to 4)
+*/
+void ViolenceCounter::addPtsdxQuartileCount(int sex, int ageCat, int ptsdType, int ptsdCase, int quartile)
+{
+	int code = -1;
+	if(sex >= 1 && sex <= (int)Violence::Sex::_size() && ageCat >= 1 && ageCat <= (int)Violence::AgeCat::_size() 
+		&& ptsdType >= 0 && ptsdType < NUM_PTSD && quartile >= 1 && quartile <= NUM_QUARTILES)
+	{
+		int row = ((sex-1)*Violence::AgeCat::_size() + (ageCat-1))*NUM_PTSD + ptsdType;
+		code = getTableCode(m_ptsdxCodes, row, ptsdCase*NUM_QUARTILES + (quartile-1), NUM_CASES*NUM_QUARTILES);
+	}
 
+	if(code >= 0)
+		addPersonTypeCount(code);
+	else
+		addPersonCount(std::to_string(sex) + std::to_string(ageCat) + std::to_string(ptsdType) 
+			+ std::to_string(ptsdCase) + std::to_string(quartile) + "Q");
 }
 
 void ViolenceCounter::addPtsdCount(int treatment, int ptsd_type, int tick)
 {
-	if(m_ptsdCount[treatment][ptsd_type].count(tick) > 0)
-		m_ptsdCount[treatment][ptsd_type].at(tick) += 1;
+	if(tick < (int)m_ptsdCount[treatment][ptsd_type].size())
+		m_ptsdCount[treatment][ptsd_type][tick] += 1;
 	else
 	{
 		std::cout << "Error: Cannot add PTSD count!" << std::endl;
@@ -137,8 +390,8 @@ void ViolenceCounter::addCbtReferredNonPtsd()
 
 void ViolenceCounter::addPtsdResolvedCount(int treatment, int ptsd_type, int tick)
 {
-	if(m_ptsdResolvedCount[treatment][ptsd_type].count(tick) > 0)
-		m_ptsdResolvedCount[treatment][ptsd_type].at(tick) += 1;
+	if(tick < (int)m_ptsdResolvedCount[treatment][ptsd_type].size())
+		m_ptsdResolvedCount[treatment][ptsd_type][tick] += 1;
 	else
 	{
 		std::cout << "Error: Cannot add PTSD resolved count!" << std::endl;
@@ -148,8 +401,8 @@ void ViolenceCounter::addPtsdResolvedCount(int treatment, int ptsd_type, int tic
 
 void ViolenceCounter::addCbtReach(int treatment, int tick)
 {
-	if(m_cbtReach[treatment].count(tick) > 0)
-		m_cbtReach[treatment].at(tick) += 1;
+	if(tick < (int)m_cbtReach[treatment].size())
+		m_cbtReach[treatment][tick] += 1;
 	else
 	{
 		std::cout << "Error: Cannot add CBT reach!" << std::endl;
@@ -159,8 +412,8 @@ void ViolenceCounter::addCbtReach(int treatment, int tick)
 
 void ViolenceCounter::addSprReach(int treatment, int tick)
 {
-	if(m_sprReach[treatment].count(tick) > 0)
-		m_sprReach[treatment].at(tick) += 1;
+	if(tick < (int)m_sprReach[treatment].size())
+		m_sprReach[treatment][tick] += 1;
 	else
 	{
 		std::cout << "Error: Cannot add SPR reach!" << std::endl;
@@ -174,7 +427,7 @@ void ViolenceCounter::addCbtCount(ViolenceAgent *agent, int tick, int treatment)
 	{
 		if(agent->getPTSDx(treatment) >= agent->getPtsdCutOff())
 		{
-			if(m_cbtCount.count(tick) > 0)
+			if(tick < (int)m_cbtCount.size())
 				m_cbtCount[tick] += 1;
 		}
 
@@ -201,7 +454,7 @@ void ViolenceCounter::addSprCount(ViolenceAgent *agent, int tick, int treatment)
 	{
 		if(agent->getPTSDx(treatment) >= agent->getPtsdCutOff())
 		{
-			if(m_sprCount.count(tick) > 0)
+			if(tick < (int)m_sprCount.size())
 				m_sprCount[tick] += 1;
 		}
 
@@ -229,7 +482,7 @@ void ViolenceCounter::addSprCount(ViolenceAgent *agent, int tick, int treatment)
 
 void ViolenceCounter::addNaturalDecayCount(int tick)
 {
-	if(m_ndCount.count(tick) > 0)
+	if(tick < (int)m_ndCount.size())
 		m_ndCount[tick] += 1;
 	else
 	{
@@ -269,13 +522,10 @@ void ViolenceCounter::computePrevalence(int tick, int totPop)
 	{
 		for(int j = 0; j < NUM_PTSD; ++j)
 		{
-			double pts_count = m_ptsdCount[i][j].at(tick);
+			double pts_count = m_ptsdCount[i][j][tick];
 			double prev = (double)pts_count/totPop;
 
-			if(m_totPrev[i][j].count(tick) > 0)
-				m_totPrev[i][j].at(tick) += prev;
-			else
-				m_totPrev[i][j].insert(std::make_pair(tick, prev));
+			m_totPrev[i][j][tick] += prev;
 
 			ptsd_count[i] += pts_count;
 		}
@@ -289,18 +539,11 @@ void ViolenceCounter::computePrevalence(int tick, int totPop)
 	prevalence.diff = computeDiff(prevalence.value, stdErr.first);
 	prevalence.ratio = computeRatio(prevalence.value, stdErr.second);
 
-	if(m_prevalence.count(tick) > 0)
-	{
-		for(int i = 0; i < NUM_TREATMENT; ++i)
-			m_prevalence[tick].value[i] += prevalence.value[i];
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+		m_prevalence[tick].value[i] += prevalence.value[i];
 
-		m_prevalence[tick].diff += prevalence.diff;
-		m_prevalence[tick].ratio += prevalence.ratio;
-	}
-	else
-	{
-		m_prevalence.insert(std::make_pair(tick, prevalence));
-	}
+	m_prevalence[tick].diff += prevalence.diff;
+	m_prevalence[tick].ratio += prevalence.ratio;
 	
 }
 
@@ -320,14 +563,11 @@ void ViolenceCounter::computeRecovery(int tick, int totPop)
 	{
 		for(int j = 0; j < NUM_PTSD; ++j)
 		{
-			double pts_count = m_ptsdCount[i][j].at(tick);
-			double res_count = m_ptsdResolvedCount[i][j].at(tick);
+			double pts_count = m_ptsdCount[i][j][tick];
+			double res_count = m_ptsdResolvedCount[i][j][tick];
 			double recov = pts_count/(pts_count+res_count);
 
-			if(m_totRecovery[i][j].count(tick) > 0)
-				m_totRecovery[i][j].at(tick) += recov;
-			else
-				m_totRecovery[i][j].insert(std::make_pair(tick, recov));
+			m_totRecovery[i][j][tick] += recov;
 
 			ptsd_count[i] += pts_count;
 			ptsd_resolved[i] += res_count;
@@ -340,18 +580,11 @@ void ViolenceCounter::computeRecovery(int tick, int totPop)
 	recovery.diff = computeDiff(recovery.value, stdErr.first);
 	recovery.ratio = computeRatio(recovery.value, stdErr.second);
 
-	if(m_recovery.count(tick) > 0)
-	{
-		for(int i = 0; i < NUM_TREATMENT; ++i)
-			m_recovery[tick].value[i] += recovery.value[i];
+	for(int i = 0; i < NUM_TREATMENT; ++i)
+		m_recovery[tick].value[i] += recovery.value[i];
 
-		m_recovery[tick].diff += recovery.diff;
-		m_recovery[tick].ratio += recovery.ratio;
-	}
-	else
-	{
-		m_recovery.insert(std::make_pair(tick, recovery));
-	}
+	m_recovery[tick].diff += recovery.diff;
+	m_recovery[tick].ratio += recovery.ratio;
 	
 }
 
@@ -361,17 +594,17 @@ void ViolenceCounter::computeReach(int tick)
 	{
 		double ptsd_cases = 0;
 		for(int j = 0; j < NUM_PTSD; ++j)
-			ptsd_cases += m_ptsdCount[i][j].at(tick);
+			ptsd_cases += m_ptsdCount[i][j][tick];
 
 		if(i == STEPPED_CARE)
 		{
 			if(ptsd_cases > 0)
-				totalReach[i][tick] += 10000*(double)(m_cbtReach[i].at(tick) + m_sprReach[i].at(tick))/ptsd_cases;
+				totalReach[i][tick] += 10000*(double)(m_cbtReach[i][tick] + m_sprReach[i][tick])/ptsd_cases;
 		}
 		else if(i == USUAL_CARE)
 		{
 			if(ptsd_cases > 0)
-				totalReach[i][tick] += 10000*(double)(m_sprReach[i].at(tick))/ptsd_cases;
+				totalReach[i][tick] += 10000*(double)(m_sprReach[i][tick])/ptsd_cases;
 		}
 	}
 }
@@ -524,7 +757,7 @@ ViolenceCounter::VectorDbls ViolenceCounter::getPrevalence(int tick, int totPop)
 	{
 		double p = 0;
 		for(int j = 0; j < NUM_PTSD; ++j)
-			p += 100*(double)m_ptsdCount[i][j].at(tick)/totPop;
+			p += 100*(double)m_ptsdCount[i][j][tick]/totPop;
 		prevalence.push_back(p);
 	}
 
@@ -540,7 +773,7 @@ double ViolenceCounter::getCbtUptake(int tick)
 {
 	int tot_ptsd = 0;
 	for(int j = 0; j < NUM_PTSD; ++j)
-		tot_ptsd += m_ptsdCount[STEPPED_CARE][j].at(tick);
+		tot_ptsd += m_ptsdCount[STEPPED_CARE][j][tick];
 
 	if (tot_ptsd != 0)
 		return 100*(double)m_cbtCount[tick]/tot_ptsd;
@@ -552,7 +785,7 @@ double ViolenceCounter::getSprUptake(int tick)
 {
 	int tot_ptsd = 0;
 	for(int j = 0; j < NUM_PTSD; ++j)
-		tot_ptsd += m_ptsdCount[STEPPED_CARE][j].at(tick);
+		tot_ptsd += m_ptsdCount[STEPPED_CARE][j][tick];
 
 	if(tot_ptsd != 0)
 		return 100*(double)m_sprCount[tick]/tot_ptsd;
@@ -564,7 +797,7 @@ double ViolenceCounter::getNaturalDecayUptake(int tick)
 {
 	int tot_ptsd = 0;
 	for(int j = 0; j < NUM_PTSD; ++j)
-		tot_ptsd += m_ptsdCount[STEPPED_CARE][j].at(tick);
+		tot_ptsd += m_ptsdCount[STEPPED_CARE][j][tick];
 
 	if(tot_ptsd != 0)
 		return 100*(double)m_ndCount[tick]/tot_ptsd;
@@ -775,8 +1008,8 @@ void ViolenceCounter::outputPtsdDistribution()
 				{
 					std::string key = std::to_string(sex)+std::to_string(ageCat)+std::to_string(exp)+std::to_string(pcase);
 
-					std::cout << key << "," << m_personCount[key+"1Q"].size() << "," << m_personCount[key+"2Q"].size()
-						<< "," << m_personCount[key+"3Q"].size() << "," << m_personCount[key+"4Q"].size() << std::endl;
+					std::cout << key << "," << getPersonCount(key+"1Q") << "," << getPersonCount(key+"2Q")
+						<< "," << getPersonCount(key+"3Q") << "," << getPersonCount(key+"4Q") << std::endl;
 				}
 			}
 		}
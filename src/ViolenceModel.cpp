@@ -8,18 +8,37 @@
 #include "ACS.h"
 #include "Random.h"
 #include "ElapsedTime.h"
+#include "ParallelBlocks.h"
 
-ViolenceModel::ViolenceModel() : schoolName("Stoneman HS")
+#include <limits>
+#include <algorithm>
+#include <functional>
+#include <unordered_map>
+
+ViolenceModel::ViolenceModel() : random(NULL), schoolName("Stoneman HS")
 {
 	
 }
 
 ViolenceModel::ViolenceModel(const char *inDir, const char *outDir, int simType, int geoLvl)
-	:PopBrewer(new ViolenceParams(inDir, outDir, simType, geoLvl)), schoolName("Stoneman HS")
+	:PopBrewer(new ViolenceParams(inDir, outDir, simType, geoLvl)), random(NULL), schoolName("Stoneman HS")
 {
 	import();
 }
 
+/*
+* @brief Class constructor of a single trial. Trial owns a copy of the parameters,
+*        its counter and a random stream seeded with the given seed.
+* @param param Parameters of the model running the trials
+* @param seed Seed of random stream of the trial
+*/
+ViolenceModel::ViolenceModel(const ViolenceParams &param, unsigned int seed) : schoolName("Stoneman HS")
+{
+	parameters = std::make_shared<ViolenceParams>(param);
+	count = new ViolenceCounter(parameters);
+	random = new Random(seed);
+}
+
 ViolenceModel::~ViolenceModel()
 {
 	delete count;
@@ -37,7 +56,6 @@ void ViolenceModel::start(std::string modelNumber)
 	if(parameters != NULL)
 	{
 		count = new ViolenceCounter(parameters);
-		random = new Random;
 	}
 	else
 	{
@@ -46,47 +64,81 @@ void ViolenceModel::start(std::string modelNumber)
 	}
 
 	int num_trials = parameters->getViolenceParam()->num_trials;
-	int sim_case = parameters->getViolenceParam()->sim_case;
+	int trial_threads = parameters->getNumTrialThreads();
+	unsigned int master_seed = (parameters->getSeed() > 0) ? parameters->getSeed() : (unsigned int)time(NULL);
+
+	Area<ViolenceParams> *metro = &m_geoAreas.at("33100");
+	//Area<ViolenceParams> *metro = &m_geoAreas.at("10180");
+	metro->createIPU();
 
-	for(int i = 0; i < num_trials; ++i)
+	//each trial runs on its own model seeded by master seed plus trial index; 
+	//trial counters are merged in trial order (see CardioModel::start)
+	for(int first = 0; first < num_trials; first += trial_threads)
 	{
-		std::cout << "Simulation no: " << i+1 << "," << sim_case << std::endl;
+		int last = std::min(num_trials, first + trial_threads);
 
-		createPopulation();
-		if(modelNumber == "Model1")
+		std::vector<ViolenceModel *> trials;
+		for(int i = first; i < last; ++i)
+			trials.push_back(new ViolenceModel(*parameters, master_seed + i));
+
+		runBlocks((int)trials.size(), 
+			[&](int t) {
+				trials[t]->runTrial(metro, first + t, modelNumber);
+			});
+
+		for(size_t t = 0; t < trials.size(); ++t)
 		{
-			groupAffectedAgents(modelNumber);
-			distributePtsdStatus();
-			runModel();
+			count->mergeOutcomes(*trials[t]->getCounter());
+			delete trials[t];
 		}
-		else if(modelNumber == "Model2")
-		{
-			AgentListMap m_tvWatchersPreIntervention, m_tvWatchersPostIntervention, m_socialMediaUsersPre, m_socialMediaUsersPost;
+	}
 
-			groupAffectedAgents(modelNumber); 
-			assignNewsSource(&m_tvWatchersPreIntervention, &m_socialMediaUsersPre);
+	if(parameters->writeToFile())
+		count->output("miami", modelNumber);
+}
 
-			for(auto scenario : Violence::Scenario::_values())
-			{
-				std::cout << "\nScenario : " << scenario._to_string() << ".." << std::endl;
-				std::string s_preIntervention = preIntervention();
+/*
+* @brief Runs a single trial: creates population, runs the model and clears the population
+* @param metro MSA for which population is created
+* @param trial Index of the trial
+* @param modelNumber Model1 or Model2
+*/
+void ViolenceModel::runTrial(Area<ViolenceParams> *metro, int trial, std::string modelNumber)
+{
+	int sim_case = parameters->getViolenceParam()->sim_case;
+	std::cout << "Simulation no: " << trial+1 << "," << sim_case << std::endl;
 
-				distributePtsdStatus(&m_tvWatchersPreIntervention, &m_socialMediaUsersPre, s_preIntervention, scenario); 
-				resetPtsdStatus(&m_tvWatchersPreIntervention, &m_socialMediaUsersPre);
+	createPopulation(metro);
+	if(modelNumber == "Model1")
+	{
+		groupAffectedAgents(modelNumber);
+		distributePtsdStatus();
+		runModel();
+	}
+	else if(modelNumber == "Model2")
+	{
+		AgentListMap m_tvWatchersPreIntervention, m_tvWatchersPostIntervention, m_socialMediaUsersPre, m_socialMediaUsersPost;
 
-				if(scenario == (int)Violence::Scenario::First)
-				{
-					processTvWatchers(&m_tvWatchersPreIntervention, &m_tvWatchersPostIntervention, scenario);
-					processSocialMediaUsers(&m_socialMediaUsersPre, &m_socialMediaUsersPost, scenario);
-				}
+		groupAffectedAgents(modelNumber); 
+		assignNewsSource(&m_tvWatchersPreIntervention, &m_socialMediaUsersPre);
+
+		for(auto scenario : Violence::Scenario::_values())
+		{
+			std::cout << "\nScenario : " << scenario._to_string() << ".." << std::endl;
+			std::string s_preIntervention = preIntervention();
+
+			distributePtsdStatus(&m_tvWatchersPreIntervention, &m_socialMediaUsersPre, s_preIntervention, scenario); 
+			resetPtsdStatus(&m_tvWatchersPreIntervention, &m_socialMediaUsersPre);
+
+			if(scenario == (int)Violence::Scenario::First)
+			{
+				processTvWatchers(&m_tvWatchersPreIntervention, &m_tvWatchersPostIntervention, scenario);
+				processSocialMediaUsers(&m_socialMediaUsersPre, &m_socialMediaUsersPost, scenario);
 			}
 		}
-		
-		clearList();
 	}
-
-	if(parameters->writeToFile())
-		count->output("miami", modelNumber);
+	
+	clearList();
 }
 
 void ViolenceModel::addHousehold(const HouseholdPums<ViolenceParams> *hh, int countHH)
@@ -95,7 +147,6 @@ void ViolenceModel::addHousehold(const HouseholdPums<ViolenceParams> *hh, int co
 		exit(EXIT_SUCCESS);
 
 	int puma_code = hh->getPUMA();
-	std::vector<PersonPums<ViolenceParams>> tempPersons;
 	int countPersons;
 
 	if(hh->getHouseholdType() >= ACS::HHType::MarriedFam)
@@ -103,7 +154,7 @@ void ViolenceModel::addHousehold(const HouseholdPums<ViolenceParams> *hh, int co
 		Household tempHH;
 		tempHH.reserve(hh->getHouseholdSize());
 
-		tempPersons = hh->getPersons();
+		const std::vector<PersonPums<ViolenceParams>> &tempPersons = hh->getPersonList();
 		countPersons = 0;
 		for(auto pp = tempPersons.begin(); pp != tempPersons.end(); ++pp)
 		{
@@ -128,17 +179,14 @@ void ViolenceModel::addAgent(const PersonPums<ViolenceParams> *p)
 	//do nothing here
 }
 
-void ViolenceModel::createPopulation()
+void ViolenceModel::createPopulation(Area<ViolenceParams> *metro)
 {
-	Area<ViolenceParams> *metro = &m_geoAreas.at("33100");
-	//Area<ViolenceParams> *metro = &m_geoAreas.at("10180");
-	
 	initializeHouseholdMap(PARKLAND);
 	//initializeHouseholdMap(TAYLOR);
 
 	std::cout << std::endl;
 	std::cout << "Creating Population for " << metro->getAreaName() << std::endl;
-	metro->createAgents(this);
+	metro->createAgents(this, random->random_int(1, std::numeric_limits<int>::max()));
 
 	createSchool(&pumaHouseholds[PARKLAND]);
 	//createSchool(&pumaHouseholds[TAYLOR]);
@@ -189,12 +237,17 @@ void ViolenceModel::distributePtsdStatus(AgentListMap *m_agents, std::string per
 	//resetPtsdStatus(m_agents, source);
 }
 
+/*
+* @brief Executes rules of each agent for every tick. With more than one thread, households
+*        are split into contiguous blocks for each tick (see runBlocks).
+*/
 void ViolenceModel::runModel()
 {
 	std::cout << std::endl;
 	std::cout << "Running mass violence model..." << std::endl;
 	int curTick = 0;
 	int countPersons;
+	int num_threads = parameters->getNumThreads();
 	
 	VecDbls prevalence;
 	AgentListPtr tempAgents;
@@ -207,20 +260,45 @@ void ViolenceModel::runModel()
 		while(curTick < getMaxWeeks())
 		{
 			countPersons = 0;
-			for(auto hh = households->begin(); hh != households->end(); ++hh)
+			if(num_threads > 1)
 			{
-				for(auto pp = hh->begin(); pp != hh->end(); ++pp)
+				std::vector<int> personCounts(num_threads, 0);
+
+				size_t blockSize = (households->size() + num_threads - 1)/num_threads;
+				runBlocks<ViolenceCounter>(num_threads, random, count, 
+					[&](int t, unsigned int seed, ViolenceCounter *shard) {
+						size_t first = std::min(households->size(), t*blockSize);
+						executeRulesBlock(households, first, std::min(households->size(), first + blockSize), curTick, seed, shard, &personCounts[t]);
+					});
+
+				for(int t = 0; t < num_threads; ++t)
+					countPersons += personCounts[t];
+
+				if(curTick == getMaxWeeks()-1)
 				{
-					ViolenceAgent *agent = (&(*pp));
-					if(agent->getAge() < getMinAge())
-						continue;
+					for(auto hh = households->begin(); hh != households->end(); ++hh)
+						for(auto pp = hh->begin(); pp != hh->end(); ++pp)
+							if(pp->getAge() >= getMinAge())
+								tempAgents.push_back(&(*pp));
+				}
+			}
+			else
+			{
+				for(auto hh = households->begin(); hh != households->end(); ++hh)
+				{
+					for(auto pp = hh->begin(); pp != hh->end(); ++pp)
+					{
+						ViolenceAgent *agent = (&(*pp));
+						if(agent->getAge() < getMinAge())
+							continue;
 
-					agent->excecuteRules(curTick);
+						agent->excecuteRules(curTick);
 					
-					if(curTick == getMaxWeeks()-1)
-						tempAgents.push_back(agent);
+						if(curTick == getMaxWeeks()-1)
+							tempAgents.push_back(agent);
 
-					countPersons++;
+						countPersons++;
+					}
 				}
 			}
 
@@ -241,6 +319,42 @@ void ViolenceModel::runModel()
 
 }
 
+/*
+* @brief Executes rules of agents of households in [first, last) for a tick
+* @param households Households of PUMA
+* @param first Index of first household of the block
+* @param last Index past the last household of the block
+* @param tick Current tick
+* @param seed Seed of random stream of the worker
+* @param shard Thread-local counter
+* @param countPersons Number of agents executed by worker
+*/
+void ViolenceModel::executeRulesBlock(std::vector<Household> *households, size_t first, size_t last, int tick, 
+	unsigned int seed, ViolenceCounter *shard, int *countPersons)
+{
+	Random rand(seed);
+	for(size_t i = first; i < last; ++i)
+	{
+		Household *hh = &households->at(i);
+		for(auto pp = hh->begin(); pp != hh->end(); ++pp)
+		{
+			ViolenceAgent *agent = (&(*pp));
+			if(agent->getAge() < getMinAge())
+				continue;
+
+			agent->setCounter(shard);
+			agent->setRandom(&rand);
+
+			agent->excecuteRules(tick);
+
+			agent->setCounter(count);
+			agent->setRandom(random);
+
+			(*countPersons)++;
+		}
+	}
+}
+
 /**
 *	@brief Creates a population for High School based on its demographics. Households are
 *	added to the list if they have agents who are less than 18 years old and attends high school
@@ -408,6 +522,11 @@ void ViolenceModel::createSocialNetwork(std::vector<Household>*households, int t
 	count = 0;
 	waitTime = 2000; //milliseconds
 
+	FriendPoolMap studentsPool, teachersPool, othersPool;
+	createFriendPools(&studentsMap, &studentsPool);
+	createFriendPools(&teachersMap, &teachersPool);
+	createFriendPools(&othersMap, &othersPool);
+
 	ElapsedTime timer;
 	for(auto hh = households->begin(); hh != households->end(); ++hh)
 	{
@@ -427,22 +546,22 @@ void ViolenceModel::createSocialNetwork(std::vector<Household>*households, int t
 					{
 						pSelection = random->uniform_real_dist();
 						if(pSelection > getPval(STUDENT))
-							findFriends(&studentsMap, a, IN_SCHOOL_NETWORK);
+							findFriends(&studentsPool, a, IN_SCHOOL_NETWORK);
 						else
-							findFriends(&othersMap, a, OUT_SCHOOL_NETWORK);
+							findFriends(&othersPool, a, OUT_SCHOOL_NETWORK);
 					}
 					else if(a->isTeacher())
 					{
 						pSelection = random->uniform_real_dist();
 						if(pSelection > getPval(TEACHER))
-							findFriends(&teachersMap, a, IN_SCHOOL_NETWORK);
+							findFriends(&teachersPool, a, IN_SCHOOL_NETWORK);
 						else
-							findFriends(&othersMap, a, OUT_SCHOOL_NETWORK);
+							findFriends(&othersPool, a, OUT_SCHOOL_NETWORK);
 					}
 				}
 				else
 				{
-					findFriends(&othersMap, a, OUT_SCHOOL_NETWORK);
+					findFriends(&othersPool, a, OUT_SCHOOL_NETWORK);
 				}
 			}
 
@@ -465,17 +584,45 @@ void ViolenceModel::createSocialNetwork(std::vector<Household>*households, int t
 }
 
 
-void ViolenceModel::findFriends(AgentListMap *agentsMap, ViolenceAgent *a, int network_type)
+/**
+*	@brief Indexes agents of each bucket (origin, or origin and education) by age
+*	@param agentsMap is map of agents by bucket
+*	@param pools is map of candidate friends by bucket
+*	@return void
+*/
+void ViolenceModel::createFriendPools(const AgentListMap *agentsMap, FriendPoolMap *pools)
+{
+	pools->clear();
+	for(auto map = agentsMap->begin(); map != agentsMap->end(); ++map)
+	{
+		FriendPool &pool = (*pools)[map->first];
+		for(auto agent = map->second.begin(); agent != map->second.end(); ++agent)
+		{
+			int age = (*agent)->getAge();
+			if(age >= (int)pool.byAge.size())
+				pool.byAge.resize(age+1);
+
+			pool.byAge[age].push_back(*agent);
+		}
+	}
+}
+
+/**
+*	@brief Finds a friend for an agent. Bucket of candidates (origin, or origin and education)
+*	is drawn from the agent's origin and education; a new bucket is drawn if no friend is found 
+*	in the drawn bucket.
+*	@param pools is map of candidate friends by bucket
+*	@param a is agent looking for a friend
+*	@param network_type is in-school or out-of-school network
+*	@return void
+*/
+void ViolenceModel::findFriends(FriendPoolMap *pools, ViolenceAgent *a, int network_type)
 {
-	bool ageMatch, genderMatch;
-	double ageChoice, genderChoice;
 	int origin, edu;
 	std::string new_key, old_key;
 
 	new_key = old_key = "";
 
-	ViolenceAgent *b = NULL;
-
 	bool match_found = false;
 	int inner_draws = 0;
 	while(!match_found)
@@ -498,51 +645,117 @@ void ViolenceModel::findFriends(AgentListMap *agentsMap, ViolenceAgent *a, int n
 		if(old_key == new_key && !old_key.empty() && !new_key.empty())
 			break;
 
-		if(agentsMap->count(new_key) > 0)
+		auto pool = pools->find(new_key);
+		if(pool != pools->end())
 		{
-			std::random_shuffle(agentsMap->at(new_key).begin(), agentsMap->at(new_key).end());
-			for(size_t i = 0; i < agentsMap->at(new_key).size(); ++i)
-			{
-				b = agentsMap->at(new_key).at(i);
-				if(!(a->isCompatible(b)))
-					continue;
-			
-				ageMatch = genderMatch = true;
-				if(a->isStudent() || b->isStudent())
-				{
-					if(abs(a->getAge()-b->getAge()) > getAgeDiffStudents())
-						ageMatch = false;
-				}
-				else
-				{
-					ageChoice = random->uniform_real_dist();
-					if(ageChoice > getPval(AGE))
-					{
-						if(abs(a->getAge()-b->getAge()) > getAgeDiffOthers())
-							ageMatch = false;
-					}
-				}
+			match_found = findFriend(&pool->second, a);
+			old_key = new_key;
+		}
+	}
+}
 
-				genderChoice = random->uniform_real_dist();
-				if(genderChoice > getPval(GENDER))
-				{
-					if(a->getSex() != b->getSex())
-						genderMatch = false;
-				}
+/**
+*	@brief Draws candidates from a bucket in random order, without replacement, until one matches
+*	the agent by age and gender. Students are only matched within the age difference of students, 
+*	so only candidates of that age window are drawn. Candidates that reached their friend size are
+*	removed from the bucket.
+*	@param pool is bucket of candidate friends
+*	@param a is agent looking for a friend
+*	@return true if a friend is found
+*/
+bool ViolenceModel::findFriend(FriendPool *pool, ViolenceAgent *a)
+{
+	bool ageMatch, genderMatch;
+	double ageChoice, genderChoice;
 
-				if(ageMatch && genderMatch)
-				{
-					a->setFriend(b);
-					b->setFriend(a);
+	std::vector<AgentListPtr> &byAge = pool->byAge;
 
-					match_found = true;
-					break;
-				}
+	int minAge = 0;
+	int maxAge = (int)byAge.size()-1;
+	if(a->isStudent())
+	{
+		minAge = std::max(minAge, a->getAge()-getAgeDiffStudents());
+		maxAge = std::min(maxAge, a->getAge()+getAgeDiffStudents());
+	}
+
+	//cumulative number of candidates by age within the window
+	std::vector<size_t> cumCount(1, 0);
+	for(int age = minAge; age <= maxAge; ++age)
+		cumCount.push_back(cumCount.back() + byAge[age].size());
+
+	size_t total = cumCount.back();
+
+	//positions moved by partial Fisher-Yates shuffle of the window
+	std::unordered_map<size_t, size_t> moved;
+	std::vector<std::pair<int, size_t>> full;
+
+	bool match_found = false;
+	for(size_t k = 0; k < total && !match_found; ++k)
+	{
+		size_t j = k + random->random_int(0, (int)(total-k-1));
+
+		size_t pos = (moved.count(j) > 0) ? moved[j] : j;
+		moved[j] = (moved.count(k) > 0) ? moved[k] : k;
+
+		int slot = (int)(std::upper_bound(cumCount.begin(), cumCount.end(), pos) - cumCount.begin()) - 1;
+		int age = minAge + slot;
+		size_t idx = pos - cumCount[slot];
+
+		ViolenceAgent *b = byAge[age][idx];
+		if(b->getTotalFriends() >= b->getFriendSize())
+		{
+			full.push_back(std::make_pair(age, idx));
+			continue;
+		}
+
+		if(!(a->isCompatible(b)))
+			continue;
+	
+		ageMatch = genderMatch = true;
+		if(a->isStudent() || b->isStudent())
+		{
+			if(abs(a->getAge()-b->getAge()) > getAgeDiffStudents())
+				ageMatch = false;
+		}
+		else
+		{
+			ageChoice = random->uniform_real_dist();
+			if(ageChoice > getPval(AGE))
+			{
+				if(abs(a->getAge()-b->getAge()) > getAgeDiffOthers())
+					ageMatch = false;
 			}
+		}
 
-			old_key = new_key;
+		genderChoice = random->uniform_real_dist();
+		if(genderChoice > getPval(GENDER))
+		{
+			if(a->getSex() != b->getSex())
+				genderMatch = false;
+		}
+
+		if(ageMatch && genderMatch)
+		{
+			a->setFriend(b);
+			b->setFriend(a);
+
+			if(b->getTotalFriends() >= b->getFriendSize())
+				full.push_back(std::make_pair(age, idx));
+
+			match_found = true;
 		}
 	}
+
+	//remove from the back of each age, so that removals don't move other candidates to be removed
+	std::sort(full.begin(), full.end(), std::greater<std::pair<int, size_t>>());
+	for(auto ff = full.begin(); ff != full.end(); ++ff)
+	{
+		AgentListPtr &agents = byAge[ff->first];
+		agents[ff->second] = agents.back();
+		agents.pop_back();
+	}
+
+	return match_found;
 }
 
 